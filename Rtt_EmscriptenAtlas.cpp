@@ -0,0 +1,397 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenAtlas.h"
+#include "Rtt_EmscriptenBitmapCache.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenImageEncoder.h"
+#include "Rtt_LuaContext.h"
+#include "Rtt_Runtime.h"
+#include "Rtt_Lua.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include <map>
+#include <algorithm>
+
+namespace Rtt
+{
+
+	//
+	// EmscriptenAtlas
+	//
+
+	// default largest image packed and page size
+	static const int kDefaultMaxImageSize = 128;
+	static const int kDefaultPageSize = 1024;
+
+	// every image is surrounded by a copy of its edge pixels, linear filtering never reaches a neighbour
+	static const int kExtrude = 1;
+
+	// page number ==> image count of pages which exist in the temporary directory
+	static std::map<int, int> sPages;
+	static int sLastPage = 0;
+
+	struct AtlasImage
+	{
+		std::string fName;
+		U8* fData;
+		int fWidth;
+		int fHeight;
+		int fPage;
+		int fX;
+		int fY;
+	};
+
+	static bool IsTaller(const AtlasImage* a, const AtlasImage* b)
+	{
+		return a->fHeight > b->fHeight;
+	}
+
+	// Page numbers are never reused, the texture cache is keyed by file name
+	// and would give a new page the texture of a released one
+	static int NewPageNumber()
+	{
+		return ++sLastPage;
+	}
+
+	static std::string PageFileName(int n)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "coronaAtlas%d.png", n);
+		return name;
+	}
+
+	// Images of a page which could not be made are reported as skipped
+	static void SkipPage(const std::vector<AtlasImage>& images, int page, std::vector<std::string>& skipped)
+	{
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			if (images[i].fPage == page)
+			{
+				skipped.push_back(images[i].fName);
+			}
+		}
+	}
+
+	// Copies straight RGBA pixels to (x, y) with extruded edges
+	static void Blit(U8* page, int pageWidth, const AtlasImage& image, int x, int y)
+	{
+		int w = image.fWidth;
+		int h = image.fHeight;
+		for (int dy = -kExtrude; dy < h + kExtrude; dy++)
+		{
+			int sy = std::min(std::max(dy, 0), h - 1);
+			const U8* src = image.fData + sy * w * 4;
+			U8* dst = page + ((y + kExtrude + dy) * pageWidth + x) * 4;
+			for (int e = 0; e < kExtrude; e++)
+			{
+				memcpy(dst + e * 4, src, 4);
+				memcpy(dst + (kExtrude + w + e) * 4, src + (w - 1) * 4, 4);
+			}
+			memcpy(dst + kExtrude * 4, src, w * 4);
+		}
+	}
+
+	// imageAtlas.build({ "a.png", ... }, { maxSize = 128, pageSize = 1024 })
+	// Relative names are in the resource directory. Returns { pages = {...}, skipped = { names }, images = count }
+	int EmscriptenAtlas::Build(lua_State *L)
+	{
+		luaL_checktype(L, 1, LUA_TTABLE);
+
+		int maxImageSize = kDefaultMaxImageSize;
+		int pageSize = kDefaultPageSize;
+		if (lua_istable(L, 2))
+		{
+			lua_getfield(L, 2, "maxSize");
+			maxImageSize = lua_isnumber(L, -1) ? (int) lua_tointeger(L, -1) : maxImageSize;
+			lua_getfield(L, 2, "pageSize");
+			pageSize = lua_isnumber(L, -1) ? (int) lua_tointeger(L, -1) : pageSize;
+			lua_pop(L, 2);
+		}
+
+		// a page must be a valid texture
+		int maxTextureSize = EmscriptenImageDecoder::GetMaxSize(true);
+		if (maxTextureSize > 0 && pageSize > maxTextureSize)
+		{
+			pageSize = maxTextureSize;
+		}
+
+		Runtime* runtime = LuaContext::GetRuntime(L);
+		const MPlatform& platform = runtime->Platform();
+
+		std::vector<AtlasImage> images;
+		std::vector<std::string> skipped;
+		int n = (int) lua_objlen(L, 1);
+		for (int i = 1; i <= n; i++)
+		{
+			lua_rawgeti(L, 1, i);
+			const char *name = lua_tostring(L, -1);
+			if (name)
+			{
+				String path(&platform.GetAllocator());
+				if (name[0] == '/')
+				{
+					path.Set(name);
+				}
+				else
+				{
+					platform.PathForFile(name, MPlatform::kResourceDir, MPlatform::kDefaultPathFlags, path);
+				}
+
+				AtlasImage image = { name, NULL, 0, 0, 0, 0, 0 };
+				float scale = 1;
+				// pages are saved as PNG and premultiplied when loaded, decode straight alpha to keep low alpha edges exact
+				image.fData = path.GetString() ? EmscriptenImageDecoder::DecodeFile(path.GetString(), image.fWidth, image.fHeight, scale, 0, false) : NULL;
+				if (image.fData && image.fWidth <= maxImageSize && image.fHeight <= maxImageSize)
+				{
+					images.push_back(image);
+				}
+				else
+				{
+					free(image.fData);
+					skipped.push_back(name);
+				}
+			}
+			lua_pop(L, 1);
+		}
+
+		// tallest first packs the skyline tightest
+		std::vector<AtlasImage*> order;
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			order.push_back(&images[i]);
+		}
+		std::stable_sort(order.begin(), order.end(), IsTaller);
+
+		std::vector<EmscriptenSkyline> skylines;
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			AtlasImage* image = order[i];
+			int w = image->fWidth + kExtrude * 2;
+			int h = image->fHeight + kExtrude * 2;
+
+			image->fPage = -1;
+			for (size_t p = 0; p < skylines.size() && image->fPage < 0; p++)
+			{
+				if (skylines[p].Insert(w, h, image->fX, image->fY))
+				{
+					image->fPage = (int) p;
+				}
+			}
+			if (image->fPage < 0)
+			{
+				skylines.push_back(EmscriptenSkyline(pageSize, pageSize));
+				if (skylines.back().Insert(w, h, image->fX, image->fY))
+				{
+					image->fPage = (int) skylines.size() - 1;
+				}
+				else
+				{
+					skylines.pop_back();
+					skipped.push_back(image->fName);
+				}
+			}
+		}
+
+		// result
+		lua_createtable(L, 0, 3);
+		lua_createtable(L, (int) skylines.size(), 0);
+
+		lua_getglobal(L, "system");
+		int system = lua_gettop(L);
+
+		int packed = 0;
+		for (size_t p = 0; p < skylines.size(); p++)
+		{
+			// pages are cut to the height used
+			int height = skylines[p].UsedHeight();
+			U8* page = (U8*) calloc(pageSize * height, 4);
+			if (page == NULL)
+			{
+				SkipPage(images, (int) p, skipped);
+				continue;
+			}
+
+			int count = 0;
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				if (images[i].fPage == (int) p)
+				{
+					Blit(page, pageSize, images[i], images[i].fX, images[i].fY);
+					count++;
+				}
+			}
+
+			int number = NewPageNumber();
+			std::string filename = PageFileName(number);
+			String path(&platform.GetAllocator());
+			platform.PathForFile(filename.c_str(), MPlatform::kTemporaryDir, MPlatform::kDefaultPathFlags, path);
+			bool saved = path.GetString() && EmscriptenImageEncoder::Save(path.GetString(), page, pageSize, height, PlatformBitmap::kRGBA, 1);
+			free(page);
+			if (!saved)
+			{
+				SkipPage(images, (int) p, skipped);
+				continue;
+			}
+
+			sPages[number] = count;
+			packed += count;
+
+			// { filename, baseDir, sheet = { frames, sheetContentWidth, sheetContentHeight }, index = { name = frame } }
+			lua_createtable(L, 0, 4);
+			lua_pushstring(L, filename.c_str());
+			lua_setfield(L, -2, "filename");
+			lua_getfield(L, system, "TemporaryDirectory");
+			lua_setfield(L, -2, "baseDir");
+
+			lua_createtable(L, 0, 3);
+			lua_createtable(L, count, 0);
+			lua_createtable(L, 0, count);
+			int frame = 0;
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				if (images[i].fPage != (int) p)
+				{
+					continue;
+				}
+
+				frame++;
+				lua_createtable(L, 0, 4);
+				lua_pushinteger(L, images[i].fX + kExtrude);
+				lua_setfield(L, -2, "x");
+				lua_pushinteger(L, images[i].fY + kExtrude);
+				lua_setfield(L, -2, "y");
+				lua_pushinteger(L, images[i].fWidth);
+				lua_setfield(L, -2, "width");
+				lua_pushinteger(L, images[i].fHeight);
+				lua_setfield(L, -2, "height");
+				lua_rawseti(L, -3, frame);
+
+				lua_pushinteger(L, frame);
+				lua_setfield(L, -2, images[i].fName.c_str());
+			}
+			lua_setfield(L, -4, "index");
+			lua_setfield(L, -2, "frames");
+			lua_pushinteger(L, pageSize);
+			lua_setfield(L, -2, "sheetContentWidth");
+			lua_pushinteger(L, height);
+			lua_setfield(L, -2, "sheetContentHeight");
+			lua_setfield(L, -2, "sheet");
+
+			lua_rawseti(L, -3, (int) lua_objlen(L, -3) + 1);
+		}
+		lua_pop(L, 1);		// system
+		lua_setfield(L, -2, "pages");
+
+		lua_createtable(L, (int) skipped.size(), 0);
+		for (size_t i = 0; i < skipped.size(); i++)
+		{
+			lua_pushstring(L, skipped[i].c_str());
+			lua_rawseti(L, -2, (int) i + 1);
+		}
+		lua_setfield(L, -2, "skipped");
+
+		lua_pushinteger(L, packed);
+		lua_setfield(L, -2, "images");
+
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			free(images[i].fData);
+		}
+		return 1;
+	}
+
+	// Deletes the pages of a build() result.
+	// Call it once the image sheets are no longer used.
+	static void ReleasePage(lua_State *L, int index, const MPlatform& platform)
+	{
+		lua_getfield(L, index, "filename");
+		const char *filename = lua_tostring(L, -1);
+		int number = 0;
+		if (filename && sscanf(filename, "coronaAtlas%d.png", &number) == 1 && sPages.erase(number) > 0)
+		{
+			String path(&platform.GetAllocator());
+			platform.PathForFile(filename, MPlatform::kTemporaryDir, MPlatform::kDefaultPathFlags, path);
+			if (path.GetString())
+			{
+				remove(path.GetString());
+				EmscriptenBitmapCache::Instance().Invalidate(path.GetString());
+			}
+		}
+		lua_pop(L, 1);
+	}
+
+	// imageAtlas.release(result) or imageAtlas.release(page)
+	int EmscriptenAtlas::Release(lua_State *L)
+	{
+		luaL_checktype(L, 1, LUA_TTABLE);
+		const MPlatform& platform = LuaContext::GetRuntime(L)->Platform();
+
+		lua_getfield(L, 1, "pages");
+		if (lua_istable(L, -1))
+		{
+			int pages = lua_gettop(L);
+			int n = (int) lua_objlen(L, pages);
+			for (int i = 1; i <= n; i++)
+			{
+				lua_rawgeti(L, pages, i);
+				if (lua_istable(L, -1))
+				{
+					ReleasePage(L, lua_gettop(L), platform);
+				}
+				lua_pop(L, 1);
+			}
+		}
+		else
+		{
+			ReleasePage(L, 1, platform);
+		}
+		lua_pop(L, 1);
+		return 0;
+	}
+
+	// imageAtlas.getStats() ==> { images, pages, texturesSaved }
+	// Each packed image would otherwise be a texture of its own, texturesSaved is the binds and batches avoided
+	int EmscriptenAtlas::GetStats(lua_State *L)
+	{
+		int images = 0;
+		for (std::map<int, int>::const_iterator it = sPages.begin(); it != sPages.end(); ++it)
+		{
+			images += it->second;
+		}
+
+		lua_createtable(L, 0, 3);
+		lua_pushinteger(L, images);
+		lua_setfield(L, -2, "images");
+		lua_pushinteger(L, (int) sPages.size());
+		lua_setfield(L, -2, "pages");
+		lua_pushinteger(L, images - (int) sPages.size());
+		lua_setfield(L, -2, "texturesSaved");
+		return 1;
+	}
+
+	int EmscriptenAtlas::Open(lua_State *L)
+	{
+		const luaL_Reg kFunctions[] =
+		{
+			{ "build", Build },
+			{ "release", Release },
+			{ "getStats", GetStats },
+			{ NULL, NULL }
+		};
+
+		lua_newtable(L);
+		luaL_register(L, NULL, kFunctions);
+		return 1;
+	}
+
+}
@@ -0,0 +1,35 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include "Rtt_EmscriptenSkyline.h"
+#include <vector>
+
+struct lua_State;
+
+namespace Rtt
+{
+
+	// Runtime texture atlas, require("imageAtlas").
+	// Small images are packed into shared pages written to the temporary directory, so they share one texture
+	// and draw in one batch through graphics.newImageSheet(page.filename, page.baseDir, page.sheet).
+	class EmscriptenAtlas
+	{
+		public:
+			static int Open(lua_State *L);
+
+		private:
+			static int Build(lua_State *L);
+			static int Release(lua_State *L);
+			static int GetStats(lua_State *L);
+	};
+
+}
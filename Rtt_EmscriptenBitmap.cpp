@@ -10,7 +10,15 @@
 #include "Core/Rtt_Build.h"
 #include "Rtt_GPUStream.h"
 #include "Rtt_EmscriptenBitmap.h"
+#include "Rtt_EmscriptenBitmapCache.h"
+#include "Rtt_EmscriptenDecodeQueue.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenImageEncoder.h"
 #include "Rtt_EmscriptenFont.h"
+#include "Rtt_EmscriptenGlyphAtlas.h"
+#include "Rtt_EmscriptenPixels.h"
+#include "Rtt_EmscriptenSaveQueue.h"
+#include "Rtt_EmscriptenTextCache.h"
 #include "Rtt_PlatformFont.h"
 #include "Display/Rtt_Display.h"
 #include "Core/Rtt_Types.h"
@@ -24,6 +32,12 @@ extern "C"
 {
 	extern int jsRenderText(void* thiz, const char* text, int width, int height, const char* alignment, const char* fontName, int fontSize);
 
+	// heap region jsRenderText copies the canvas pixels into
+	uint8_t* EMSCRIPTEN_KEEPALIVE jsEmscriptenTextBuffer(int size)
+	{
+		return Rtt::EmscriptenTextBitmap::GetStagingBuffer(size);
+	}
+
 	// Java ==> Lua callback
 	void EMSCRIPTEN_KEEPALIVE jsEmscriptenBitmapSaveImage(Rtt::EmscriptenTextBitmap* thiz, int size, uint8_t* image, int w, int h, int isSafari)
 	{
@@ -74,6 +88,8 @@ namespace Rtt
 	// EmscriptenBaseBitmap
 	//
 
+	EmscriptenBaseBitmap::MemoryStats EmscriptenBaseBitmap::sMemoryStats = { 0, 0, 0 };
+
 	EmscriptenBaseBitmap::EmscriptenBaseBitmap()
 		: Super()
 		, fData(NULL)
@@ -81,50 +97,178 @@ namespace Rtt
 		, fHeight(0)
 		, fFormat(kUndefined)
 		, fProperties(0)
+		, fScale(1)
+		, fMaxSize(0)
+		, fIsReleased(false)
 	{
 	}
 
 	EmscriptenBaseBitmap::EmscriptenBaseBitmap(Rtt_Allocator *context, int w, int h, uint8_t* rgba)
 		: Super()
 		, fData(NULL)
-		, fWidth(w)
-		, fHeight(h)
-		, fFormat(kRGBA)
+		, fWidth(0)
+		, fHeight(0)
+		, fFormat(kUndefined)
 		, fProperties(0)
+		, fScale(1)
+		, fMaxSize(0)
+		, fIsReleased(false)
 	{
-		int size = fHeight * fWidth * 4;
-		fData = (U8*)Rtt_MALLOC(&context, size);
-		memset(fData, 0, size);
-		
-		U8* dst = fData;
-		for (int y = 0; y < h; y++)
+		U8* data = (U8*)Rtt_MALLOC(&context, w * h * 4);
+
+		// premultiple alpha
+		if (EmscriptenPixels::IsOpaque(rgba, w * h))
 		{
-			for (int x = 0; x < w; x++)
-			{
-				// premultiple alpha
-				dst[0] = (rgba[0] * rgba[3]) >> 8;
-				dst[1] = (rgba[1] * rgba[3]) >> 8;
-				dst[2] = (rgba[2] * rgba[3]) >> 8;
-				dst[3] = rgba[3];
-
-				dst += 4;
-				rgba += 4;
-			}
+			memcpy(data, rgba, w * h * 4);
+		}
+		else
+		{
+			EmscriptenPixels::Premultiply(data, rgba, w * h);
+		}
+
+		SetData(data, w, h, kRGBA);
+	}
+
+	EmscriptenBaseBitmap::EmscriptenBaseBitmap(int w, int h, U8* rgba)
+		: Super()
+		, fData(NULL)
+		, fWidth(0)
+		, fHeight(0)
+		, fFormat(kUndefined)
+		, fProperties(0)
+		, fScale(1)
+		, fMaxSize(0)
+		, fIsReleased(false)
+	{
+		// camera frames are opaque, premultiplying them changes nothing
+		if (!EmscriptenPixels::IsOpaque(rgba, w * h))
+		{
+			EmscriptenPixels::Premultiply(rgba, rgba, w * h);
 		}
-		
-		fFormat = kRGBA;
+
+		SetData(rgba, w, h, kRGBA);
 	}
 
 	EmscriptenBaseBitmap::~EmscriptenBaseBitmap()
 	{
-		free(fData);
+		if (fIsReleased)
+		{
+			sMemoryStats.fReleased -= BitsSize();
+		}
+		SetData(NULL, fWidth, fHeight, fFormat);
+	}
+
+	size_t EmscriptenBaseBitmap::BitsSize() const
+	{
+		switch (fFormat)
+		{
+			case kMask:
+				return fWidth * fHeight;
+			case kRGB:
+				return fWidth * fHeight * 3;
+			default:
+				return fWidth * fHeight * 4;
+		}
+	}
+
+	void EmscriptenBaseBitmap::SetData(U8* data, int w, int h, Format format) const
+	{
+		if (fData)
+		{
+			sMemoryStats.fResident -= BitsSize();
+			free(fData);
+		}
+
+		fData = data;
+		fWidth = w;
+		fHeight = h;
+		fFormat = format;
+		if (fData)
+		{
+			sMemoryStats.fResident += BitsSize();
+		}
 	}
 
 	const void* EmscriptenBaseBitmap::GetBits(Rtt_Allocator *context) const
 	{
+		if (fData == NULL && fIsReleased)
+		{
+			Restore();
+		}
 		return fData;
 	}
 
+	void EmscriptenBaseBitmap::FreeBits() const
+	{
+		// only what can be decoded again is released
+		if (fData && GetPath())
+		{
+			SetData(NULL, fWidth, fHeight, fFormat);
+			sMemoryStats.fReleased += BitsSize();
+			fIsReleased = true;
+		}
+	}
+
+	// Decodes released pixels again, with the size limit they were first decoded with
+	bool EmscriptenBaseBitmap::Restore() const
+	{
+		const char* path = GetPath();
+		int width = 0, height = 0;
+		float scale = 1;
+		U8* data = EmscriptenBitmapCache::Instance().Get(path, width, height, scale);
+		if (data == NULL || width != fWidth || height != fHeight)
+		{
+			free(data);
+			data = EmscriptenImageDecoder::DecodeFile(path, width, height, scale, fMaxSize);
+		}
+
+		// the texture was created with the original size, the file must not have changed since
+		if (data == NULL || width != fWidth || height != fHeight)
+		{
+			Rtt_LogException("Failed to restore %s\n", path);
+			free(data);
+			return false;
+		}
+
+		if (fFormat == kMask)
+		{
+			U8* mask = ToMask(data, width * height);
+			free(data);
+			data = mask;
+		}
+
+		sMemoryStats.fReleased -= BitsSize();
+		sMemoryStats.fRestores++;
+		fIsReleased = false;
+		SetData(data, width, height, fFormat);
+		return fData != NULL;
+	}
+
+	bool EmscriptenBaseBitmap::MoveToCache() const
+	{
+		const char* path = GetPath();
+		if (fData == NULL || path == NULL || fFormat != kRGBA || fMaxSize != EmscriptenImageDecoder::GetMaxSize(false))
+		{
+			return false;
+		}
+
+		sMemoryStats.fResident -= BitsSize();
+		EmscriptenBitmapCache::Instance().Put(path, fData, fWidth, fHeight, fScale);
+		fData = NULL;
+		return true;
+	}
+
+	// grayscale copy of RGBA pixels
+	U8* EmscriptenBaseBitmap::ToMask(const U8* rgba, int size)
+	{
+		U8* mask = (U8*) malloc(size);
+		if (mask)
+		{
+			EmscriptenPixels::Luminance(mask, rgba, size, 4);
+		}
+		return mask;
+	}
+
 	U32 EmscriptenBaseBitmap::Width() const
 	{
 		//	return ( ! IsPropertyInternal( kIsBitsAutoRotated ) ? SourceWidth() : UprightWidth() );
@@ -142,6 +286,11 @@ namespace Rtt
 		return fFormat;
 	}
 
+	Real EmscriptenBaseBitmap::GetScale() const
+	{
+		return fScale;
+	}
+
 	bool EmscriptenBaseBitmap::IsProperty(PropertyMask mask) const
 	{
 		return IsPropertyInternal(mask);
@@ -171,93 +320,20 @@ namespace Rtt
 	{
 		Rtt_ASSERT(fData == NULL);
 
-		// get file ext
-		int n = strlen(path);
-		if (n < 5)
-		{
-			return false;
-		}
-
-		std::string ext = path + n - 4;
-		if (ext == ".bmp")
-		{
-			fData = bitmapUtil::loadBMP(path, fWidth, fHeight, fFormat);
-			if (fData)
-			{
-				fFormat = kRGBA;
-			}
-		}
-		else
-		if (ext == ".png")
-		{
-			FILE* f = fopen(path, "rb");
-			if (f)
-			{
-				fData = bitmapUtil::loadPNG(f, fWidth, fHeight);
-				if (fData)
-				{
-					fFormat = kRGBA;
-				}
-				fclose(f);
-			}
-		}
-		else
-		if (ext == ".jpg")
-		{
-			FILE* f = fopen(path, "rb");
-			if (f)
-			{
-				uint8_t* img = bitmapUtil::loadJPG(f, fWidth, fHeight);
-				if (img)
-				{
-					// convert to RGBA, for some reason RGB images are rendered incorrectly
-					fData = (uint8_t*) malloc(fWidth * fHeight * 4);
-					fFormat = kRGBA;
-
-					U8* src = img;
-					U8* dst = fData;
-					for (int y = 0; y < fHeight; y++)
-					{
-						for (int x = 0; x < fWidth; x++)
-						{
-							dst[0] = src[0];
-							dst[1] = src[1];
-							dst[2] = src[2];
-							dst[3] = 255;
-							dst += 4;
-							src += 3;
-						}
-					}
-					free(img);
-				}
-				fclose(f);
-				return fData != NULL;
-			}
-		}
+		// prefetched images are decoded already
+		int width = 0, height = 0;
+		fMaxSize = EmscriptenImageDecoder::GetMaxSize(false);
+		U8* data = EmscriptenDecodeQueue::Instance().Load(path, width, height, fScale);
 
-		if (fData && fFormat == kRGBA)
+		if (data)
 		{
-			U8* dst = fData;
-			for (int y = 0; y < fHeight; y++)
-			{
-				for (int x = 0; x < fWidth; x++)
-				{
-					// premultiple alpha
-					if (dst[3] < 255)
-					{
-						dst[0] = (dst[0] * dst[3]) >> 8;
-						dst[1] = (dst[1] * dst[3]) >> 8;
-						dst[2] = (dst[2] * dst[3]) >> 8;
-					}
-					dst += 4;
-				}
-			}
+			SetData(data, width, height, kRGBA);
 		}
 
 		return fData != NULL;
 	}
 
-	bool EmscriptenBaseBitmap::SaveBitmap(Rtt_Allocator* context, PlatformBitmap * bitmap, const char * filePath)
+	bool EmscriptenBaseBitmap::SaveBitmap(Rtt_Allocator* context, PlatformBitmap * bitmap, const char * filePath, float quality)
 	{
 		// Validate.
 		if ((NULL == bitmap) || (NULL == filePath))
@@ -265,9 +341,12 @@ namespace Rtt
 			return false;
 		}
 
-		if (strcmp(filePath + strlen(filePath) - 4, ".png") != 0)
+		// the modification time has a resolution of seconds, a file saved again may look unchanged
+		EmscriptenBitmapCache::Instance().Invalidate(filePath);
+
+		if (EmscriptenImageEncoder::GetType(filePath) == EmscriptenImageEncoder::kUnknown)
 		{
-			Rtt_LogException("Failed to save %s, HTML5 supports only .png files\n", filePath);
+			Rtt_LogException("Failed to save %s, HTML5 supports .png, .jpg and .webp files\n", filePath);
 			return false;
 		}
 
@@ -285,7 +364,12 @@ namespace Rtt
 			return false;
 		}
 
-		return bitmapUtil::savePNG(filePath, bits, w, h, bitmap->GetFormat());
+		EmscriptenSaveQueue& queue = EmscriptenSaveQueue::Instance();
+		if (queue.IsAsync())
+		{
+			return queue.Save(filePath, bits, w, h, bitmap->GetFormat(), quality);
+		}
+		return EmscriptenImageEncoder::Save(filePath, bits, w, h, bitmap->GetFormat(), quality);
 	}
 
 	//
@@ -301,6 +385,27 @@ namespace Rtt
 
 	EmscriptenFileBitmap::~EmscriptenFileBitmap()
 	{
+		// the base class can no longer see the path
+		MoveToCache();
+	}
+
+	void EmscriptenFileBitmap::SetProperty(PropertyMask mask, bool newValue)
+	{
+		Super::SetProperty(mask, newValue);
+
+		if (mask == kIsBitsFullResolution && newValue && fScale < 1)
+		{
+			int width = 0, height = 0;
+			float scale = 1;
+			int maxSize = EmscriptenImageDecoder::GetMaxSize(true);
+			U8* data = EmscriptenImageDecoder::DecodeFile(fPath.GetString(), width, height, scale, maxSize);
+			if (data)
+			{
+				SetData(data, width, height, kRGBA);
+				fScale = scale;
+				fMaxSize = maxSize;
+			}
+		}
 	}
 	 
 	//
@@ -313,24 +418,10 @@ namespace Rtt
 	{
 		if (LoadFileBitmap(context, filePath))
 		{
-			Rtt_ASSERT(fFormat == kRGBA || fFormat == kRGB);
+			Rtt_ASSERT(fFormat == kRGBA);
 
 			// convert to grayscale
-			int size = fHeight * fWidth;
-			U8* newData = (U8*)Rtt_MALLOC(&context, size);
-			U8* src = fData;
-			U8* dst = newData;
-			for (int y = 0; y < fHeight; y++)
-			{
-				for (int x = 0; x < fWidth; x++)
-				{
-					*dst++ = (U8)(0.30f * src[0] + 0.59f * src[1] + 0.11f * src[2]);
-					src += (fFormat == kRGBA) ? 4 : 3;
-				}
-			}
-			free(fData);
-			fData = newData;
-			fFormat = kMask;
+			SetData(ToMask(fData, fWidth * fHeight), fWidth, fHeight, kMask);
 		}
 	}
 
@@ -347,35 +438,81 @@ namespace Rtt
 		: Super()
 		, fWrapWidth(width)
 		, fAlignment(&context, alignment)
+		, fIsShared(false)
 	{
-		jsRenderText(this, str, width, height, alignment, inFont.Name(), inFont.Size());
+		EmscriptenGlyphAtlas& atlas = EmscriptenGlyphAtlas::Instance();
+		EmscriptenTextCache& cache = EmscriptenTextCache::Instance();
+		fCacheKey = EmscriptenTextCache::MakeKey(str, inFont.Name(), inFont.Size(), width, height, alignment, atlas.IsEnabled());
+
+		int w = 0;
+		int h = 0;
+		const U8* shared = cache.Acquire(fCacheKey, w, h);
+		if (shared)
+		{
+			// the cache owns the pixels and accounts for them
+			fData = (U8*) shared;
+			fWidth = w;
+			fHeight = h;
+			fFormat = kMask;
+			fIsShared = true;
+		}
+		else
+		{
+			U8* data = atlas.Render(str, inFont.Name(), inFont.Size(), width, height, alignment, w, h);
+			if (data)
+			{
+				SetData(data, w, h, kMask);
+			}
+			else
+			{
+				jsRenderText(this, str, width, height, alignment, inFont.Name(), EmscriptenGlyphAtlas::PixelSize(inFont.Size()));
+			}
+
+			if (fData && cache.Put(fCacheKey, fData, fWidth, fHeight))
+			{
+				sMemoryStats.fResident -= BitsSize();
+				fIsShared = true;
+			}
+		}
 		baselineOffset = fHeight * 0.5f - inFont.Size();
 	}
 
-	void EmscriptenTextBitmap::setBitmap(int size, uint8_t* image, int w, int h, int isSafari)
+	// Canvas pixels are copied into one reused heap region, no malloc and free per text
+	U8* EmscriptenTextBitmap::GetStagingBuffer(int size)
 	{
-		fWidth = w;
-		fHeight = h;
-
-		fData = (U8*)Rtt_MALLOC(&context, fHeight * fWidth);
-		memset(fData, 0, fHeight * fWidth);
-
-		// extract alpha component
-		int pitch = w * 4;		// rgba
-		int bpp = 4;
-		for (int y = 0; y < h; y++)
+		static U8* sBuffer = NULL;
+		static int sSize = 0;
+		if (size > sSize)
 		{
-			for (int x = 0; x < w; x++)
+			U8* buffer = (U8*) realloc(sBuffer, size);
+			if (buffer == NULL)
 			{
-				// Here p is the address to the pixel we want to retrieve
-				uint8_t *p = image + y * pitch + x * bpp;
-				fData[y*w + x] = (isSafari == 1) ? p[0] : p[3];
+				return NULL;
 			}
+			sBuffer = buffer;
+			sSize = size;
 		}
+		return sBuffer;
+	}
+
+	void EmscriptenTextBitmap::setBitmap(int size, uint8_t* image, int w, int h, int isSafari)
+	{
+		U8* data = (U8*) malloc(w * h);
+		if (data)
+		{
+			// Safari text is drawn red and read from the red channel
+			EmscriptenPixels::ExtractChannel(data, image, w * h, (isSafari == 1) ? 0 : 3);
+		}
+		SetData(data, w, h, kMask);
 	}
 
 	EmscriptenTextBitmap::~EmscriptenTextBitmap()
 	{
+		if (fIsShared)
+		{
+			fData = NULL;
+			EmscriptenTextCache::Instance().Release(fCacheKey);
+		}
 	}
 
 	PlatformBitmap::Format EmscriptenTextBitmap::GetFormat() const
@@ -12,6 +12,7 @@
 #include "Display/Rtt_PlatformBitmap.h"
 #include "Core/Rtt_Array.h"
 #include "Core/Rtt_String.h"
+#include <string>
 
 namespace Rtt
 {
@@ -31,29 +32,61 @@ class EmscriptenBaseBitmap : public PlatformBitmap
 		}
 		Channel;
 
+		// pixel memory of all bitmaps in the wasm heap
+		struct MemoryStats
+		{
+			size_t fResident;		// bytes held by bitmaps
+			size_t fReleased;		// bytes freed after upload, only the GPU texture remains
+			U32 fRestores;			// released pixels decoded again
+		};
+		static MemoryStats GetMemoryStats() { return sMemoryStats; }
+
 	public:
 		EmscriptenBaseBitmap();
 		EmscriptenBaseBitmap(Rtt_Allocator *context, int w, int h, uint8_t* rgba);
+
+		// Takes ownership of malloc'ed straight RGBA pixels, premultiplied in place unless opaque
+		EmscriptenBaseBitmap(int w, int h, U8* rgba);
 		virtual ~EmscriptenBaseBitmap();
 
+		// File bitmaps are released once uploaded and decoded again when the texture needs them,
+		// e.g. after a WebGL context loss
 		virtual const void * GetBits( Rtt_Allocator *context ) const;
-		virtual void FreeBits() const override {};
+		virtual void FreeBits() const override;
 		virtual U32 Width() const;
 		virtual U32 Height() const;
 		virtual Format GetFormat() const;
+		virtual Real GetScale() const;
 		virtual bool IsProperty( PropertyMask mask ) const;
 		virtual void SetProperty( PropertyMask mask, bool newValue );
 		bool LoadFileBitmap(Rtt_Allocator &context, const char *path);
-		static bool SaveBitmap(Rtt_Allocator *context, PlatformBitmap * bitmap, const char * filePath);
+		// .png, .jpg or .webp by extension, written on a worker thread when EmscriptenSaveQueue is async
+		static bool SaveBitmap(Rtt_Allocator *context, PlatformBitmap * bitmap, const char * filePath, float quality);
 
 	protected:
 		Rtt_INLINE bool IsPropertyInternal( PropertyMask mask ) const { return (fProperties & mask) ? true : false; }
 
+		// Source of released pixels, NULL for bitmaps which can not be restored
+		virtual const char* GetPath() const { return NULL; }
+
+		// Frees the current pixels and takes data, keeps the memory stats
+		void SetData(U8* data, int w, int h, Format format) const;
+		size_t BitsSize() const;
+		bool Restore() const;
+		// Hands RGBA pixels decoded with the default size limit over to EmscriptenBitmapCache
+		bool MoveToCache() const;
+		static U8* ToMask(const U8* rgba, int size);
+
 		mutable U8 *fData;
 		mutable S32 fWidth;
 		mutable S32 fHeight;
-		Format fFormat;
+		mutable Format fFormat;
 		U8 fProperties;
+		float fScale;		// decoded / original size, below 1 for images reduced at load time
+		int fMaxSize;		// size limit the pixels were decoded with, a restore must match it
+		mutable bool fIsReleased;
+
+		static MemoryStats sMemoryStats;
 };
 
 class EmscriptenFileBitmap : public EmscriptenBaseBitmap
@@ -64,6 +97,12 @@ class EmscriptenFileBitmap : public EmscriptenBaseBitmap
 		EmscriptenFileBitmap(Rtt_Allocator& context, const char *filePath);
 		virtual ~EmscriptenFileBitmap();
 
+		// isFullResolution decodes a reduced image again without the soft size limit
+		virtual void SetProperty( PropertyMask mask, bool newValue );
+
+	protected:
+		virtual const char* GetPath() const { return fPath.GetString(); }
+
 	private:
 		String fPath;
 };
@@ -76,7 +115,10 @@ class EmscriptenMaskFileBitmap : public EmscriptenBaseBitmap
 
 		EmscriptenMaskFileBitmap(Rtt_Allocator& context, const char *filePath);
 		virtual ~EmscriptenMaskFileBitmap();
-		
+
+	protected:
+		virtual const char* GetPath() const { return fPath.GetString(); }
+
 	private:
 		String fPath;
 };
@@ -91,6 +133,9 @@ class EmscriptenTextBitmap : public EmscriptenBaseBitmap
 		virtual ~EmscriptenTextBitmap();
 		void setBitmap(int size, uint8_t* image, int w, int h, int isSafari);
 
+		// RGBA staging for the canvas renderer, grown to the largest text so far
+		static U8* GetStagingBuffer(int size);
+
 		virtual void FreeBits() const override {};
 		virtual PlatformBitmap::Format GetFormat() const;
 		virtual U8 GetByteAlignment() const;
@@ -101,6 +146,8 @@ class EmscriptenTextBitmap : public EmscriptenBaseBitmap
 
 		int fWrapWidth;
 		String fAlignment;
+		std::string fCacheKey;
+		bool fIsShared;		// fData belongs to EmscriptenTextCache
 };
 
 // ----------------------------------------------------------------------------
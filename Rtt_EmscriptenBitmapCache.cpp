@@ -0,0 +1,180 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenBitmapCache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace Rtt
+{
+
+	// default budget, about two 2048x2048 backgrounds
+	static const size_t kDefaultBudget = 32 * 1024 * 1024;
+
+	EmscriptenBitmapCache& EmscriptenBitmapCache::Instance()
+	{
+		static EmscriptenBitmapCache sCache;
+		return sCache;
+	}
+
+	EmscriptenBitmapCache::EmscriptenBitmapCache()
+		: fBudget(kDefaultBudget)
+	{
+		memset(&fStats, 0, sizeof(fStats));
+	}
+
+	EmscriptenBitmapCache::~EmscriptenBitmapCache()
+	{
+		Clear();
+	}
+
+	bool EmscriptenBitmapCache::GetFileInfo(const char* path, time_t& modified, long& size)
+	{
+		struct stat st;
+		if (stat(path, &st) != 0)
+		{
+			return false;
+		}
+		modified = st.st_mtime;
+		size = (long) st.st_size;
+		return true;
+	}
+
+	// Finds a valid entry, a stale one (file changed) is dropped
+	EmscriptenBitmapCache::EntryList::iterator EmscriptenBitmapCache::Find(const char* path)
+	{
+		std::map<std::string, EntryList::iterator>::iterator it = fIndex.find(path);
+		if (it == fIndex.end())
+		{
+			return fEntries.end();
+		}
+
+		EntryList::iterator entry = it->second;
+		time_t modified;
+		long size;
+		if (!GetFileInfo(path, modified, size) || modified != entry->fModified || size != entry->fFileSize)
+		{
+			Remove(entry);
+			return fEntries.end();
+		}
+		return entry;
+	}
+
+	U8* EmscriptenBitmapCache::Get(const char* path, int& width, int& height, float& scale)
+	{
+		if (fBudget == 0)
+		{
+			return NULL;
+		}
+
+		EntryList::iterator entry = Find(path);
+		if (entry == fEntries.end())
+		{
+			fStats.fMisses++;
+			return NULL;
+		}
+
+		// the bitmap owns the pixels until it gives them back
+		U8* data = entry->fData;
+		width = entry->fWidth;
+		height = entry->fHeight;
+		scale = entry->fScale;
+		entry->fData = NULL;
+		Remove(entry);
+
+		fStats.fHits++;
+		return data;
+	}
+
+	bool EmscriptenBitmapCache::Contains(const char* path)
+	{
+		return fBudget > 0 && Find(path) != fEntries.end();
+	}
+
+	void EmscriptenBitmapCache::Invalidate(const char* path)
+	{
+		std::map<std::string, EntryList::iterator>::iterator it = fIndex.find(path);
+		if (it != fIndex.end())
+		{
+			Remove(it->second);
+		}
+	}
+
+	void EmscriptenBitmapCache::Put(const char* path, U8* data, int width, int height, float scale)
+	{
+		size_t bytes = (size_t) width * height * 4;
+		Entry e;
+		if (data == NULL || bytes == 0 || bytes > fBudget || !GetFileInfo(path, e.fModified, e.fFileSize))
+		{
+			free(data);
+			return;
+		}
+
+		std::map<std::string, EntryList::iterator>::iterator it = fIndex.find(path);
+		if (it != fIndex.end())
+		{
+			Remove(it->second);
+		}
+
+		Evict(bytes);
+
+		e.fData = data;
+		e.fPath = path;
+		e.fWidth = width;
+		e.fHeight = height;
+		e.fScale = scale;
+
+		fEntries.push_front(e);
+		fIndex[e.fPath] = fEntries.begin();
+		fStats.fBytes += bytes;
+		fStats.fCount++;
+	}
+
+	// Drops least recently used entries until 'bytes' more fit in the budget
+	void EmscriptenBitmapCache::Evict(size_t bytes)
+	{
+		while (!fEntries.empty() && fStats.fBytes + bytes > fBudget)
+		{
+			EntryList::iterator last = fEntries.end();
+			Remove(--last);
+			fStats.fEvictions++;
+		}
+	}
+
+	void EmscriptenBitmapCache::Remove(EntryList::iterator it)
+	{
+		fStats.fBytes -= it->fWidth * it->fHeight * 4;
+		fStats.fCount--;
+		free(it->fData);
+		fIndex.erase(it->fPath);
+		fEntries.erase(it);
+	}
+
+	void EmscriptenBitmapCache::SetBudget(size_t bytes)
+	{
+		fBudget = bytes;
+		Evict(0);
+	}
+
+	void EmscriptenBitmapCache::Clear()
+	{
+		while (!fEntries.empty())
+		{
+			Remove(fEntries.begin());
+		}
+	}
+
+	EmscriptenBitmapCache::Stats EmscriptenBitmapCache::GetStats() const
+	{
+		return fStats;
+	}
+
+}
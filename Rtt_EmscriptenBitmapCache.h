@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include <string>
+#include <list>
+#include <map>
+#include <time.h>
+
+namespace Rtt
+{
+
+	// LRU cache of decoded premultiplied RGBA images keyed by path and modification time.
+	// File bitmaps hand their pixels over when they are destroyed, so an image which comes back is not
+	// decoded again. Pixels freed after upload are not kept, their texture is still on the GPU.
+	// Pixels live either in a bitmap or here, never in both.
+	// Main thread only.
+	class EmscriptenBitmapCache
+	{
+	public:
+		struct Stats
+		{
+			U32 fHits;
+			U32 fMisses;
+			U32 fEvictions;
+			size_t fBytes;
+			size_t fCount;
+		};
+
+		static EmscriptenBitmapCache& Instance();
+
+		EmscriptenBitmapCache();
+		~EmscriptenBitmapCache();
+
+		// Hands the cached pixels over and drops the entry, NULL on a miss or when the file has changed
+		U8* Get(const char* path, int& width, int& height, float& scale);
+		bool Contains(const char* path);
+
+		// Drops the entry of a file which is rewritten or deleted
+		void Invalidate(const char* path);
+
+		// Takes ownership of malloc'ed pixels, they are freed when they do not fit in the budget
+		void Put(const char* path, U8* data, int width, int height, float scale);
+
+		// 0 disables the cache
+		void SetBudget(size_t bytes);
+		size_t GetBudget() const { return fBudget; }
+
+		void Clear();
+		Stats GetStats() const;
+
+	private:
+		struct Entry
+		{
+			std::string fPath;
+			time_t fModified;
+			long fFileSize;
+			U8* fData;
+			int fWidth;
+			int fHeight;
+			float fScale;		// decoded / original size
+		};
+		typedef std::list<Entry> EntryList;
+
+		static bool GetFileInfo(const char* path, time_t& modified, long& size);
+		EntryList::iterator Find(const char* path);
+		void Evict(size_t bytes);
+		void Remove(EntryList::iterator it);
+
+		EntryList fEntries;		// most recently used first
+		std::map<std::string, EntryList::iterator> fIndex;
+		size_t fBudget;
+		Stats fStats;
+	};
+
+}
@@ -333,6 +333,136 @@ private:
 	mutable weak_proxy*	m_weak_proxy;
 };
 
+// Generational slot map.  Handles stay valid while their element
+// lives, lookups are O(1), and a handle whose element was removed is
+// detected as stale even after its slot is reused.  A handle is
+// (generation << index_bits) | index and is never negative, so it can
+// go to Lua as an integer.
+template<class T>
+class slot_map
+{
+public:
+	enum
+	{
+		index_bits = 20,
+		max_size = 1 << index_bits,
+		generation_mask = (1 << (31 - index_bits)) - 1,
+	};
+
+	slot_map() : m_slots(NULL), m_capacity(0), m_used(0), m_free(-1), m_count(0) {}
+	~slot_map() { delete [] m_slots; }
+
+	// Returns the handle, -1 if the map is full
+	int	insert(const T& value)
+	{
+		int index = m_free;
+		if (index >= 0)
+		{
+			m_free = m_slots[index].next_free;
+		}
+		else
+		{
+			if (m_used == max_size)
+			{
+				return -1;
+			}
+			if (m_used == m_capacity)
+			{
+				grow();
+			}
+			index = m_used++;
+		}
+
+		slot& s = m_slots[index];
+		s.value = value;
+		s.alive = true;
+		m_count++;
+		return (s.generation << index_bits) | index;
+	}
+
+	// NULL for a removed or invalid handle
+	T*	get(int handle)
+	{
+		slot* s = find(handle);
+		return s ? &s->value : NULL;
+	}
+
+	// false for a removed or invalid handle
+	bool	remove(int handle)
+	{
+		slot* s = find(handle);
+		if (s == NULL)
+		{
+			return false;
+		}
+
+		// the next element in this slot gets a new generation, generation 0 is never used
+		s->value = T();
+		s->alive = false;
+		s->generation = (s->generation + 1) & generation_mask;
+		if (s->generation == 0)
+		{
+			s->generation = 1;
+		}
+		s->next_free = m_free;
+		m_free = (int) (s - m_slots);
+		m_count--;
+		return true;
+	}
+
+	int	size() const { return m_count; }
+
+private:
+	struct slot
+	{
+		slot() : generation(1), next_free(-1), alive(false) {}
+
+		T	value;
+		int	generation;
+		int	next_free;
+		bool	alive;
+	};
+
+	slot*	find(int handle) const
+	{
+		if (handle < 0)
+		{
+			return NULL;
+		}
+		int index = handle & (max_size - 1);
+		int generation = handle >> index_bits;
+		if (index >= m_used || !m_slots[index].alive || m_slots[index].generation != generation)
+		{
+			return NULL;
+		}
+		return &m_slots[index];
+	}
+
+	void	grow()
+	{
+		int capacity = m_capacity > 0 ? m_capacity * 2 : 16;
+		slot* slots = new slot[capacity];
+		for (int i = 0; i < m_used; i++)
+		{
+			slots[i] = m_slots[i];
+		}
+		delete [] m_slots;
+		m_slots = slots;
+		m_capacity = capacity;
+	}
+
+	// Don't use these.
+	slot_map(const slot_map&);
+	void	operator=(const slot_map&);
+
+	slot*	m_slots;
+	int	m_capacity;
+	int	m_used;		// slots ever handed out
+	int	m_free;		// head of the free slot list
+	int	m_count;
+};
+
+
 typedef signed char	Sint8;
 typedef unsigned char	Uint8;
 typedef unsigned short Uint16;
@@ -12,6 +12,10 @@
 #include "Rtt_LuaContext.h"
 #include "Core/Rtt_Types.h"
 #include "Rtt_EmscriptenContext.h"
+#include "Rtt_EmscriptenDecodeQueue.h"
+#include "Rtt_EmscriptenGlyphAtlas.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenSaveQueue.h"
 #include "Rtt_EmscriptenPlatform.h"
 #include "Rtt_EmscriptenRuntimeDelegate.h"
 #include "Rtt_LuaFile.h"
@@ -21,6 +25,10 @@
 #include "Display/Rtt_DisplayDefaults.h"
 #include "Rtt_KeyName.h"
 
+#if defined(EMSCRIPTEN)
+#include <GLES2/gl2.h>
+#endif
+
 #ifdef WIN32
 	#define strncasecmp _strnicmp
 	#define strcasecmp stricmp
@@ -43,7 +51,7 @@ extern "C"
 	extern void jsContextResizeNativeObjects();
 	extern int jsContextMountFS();
 	extern int jsContextGetIntModuleItem(const char* name);
-	extern int jsContextLoadFonts(const char* name, void* buf, int size);
+	extern int jsContextLoadFonts(const char* name);
 	extern void jsContextSetClearColor(int r, int g, int b, int a);
 	extern void jsContextConfig(int w, int h);
 }
@@ -57,7 +65,7 @@ extern "C"
 	void jsContextResizeNativeObjects() {}
 	int jsContextMountFS() { return 1; }
 	int jsContextGetIntModuleItem(const char* name) { return 1; }
-	int jsContextLoadFonts(const char* name, void* buf, int size)  { return 0; }
+	int jsContextLoadFonts(const char* name)  { return 0; }
 	void jsContextSetClearColor(int r, int g, int b, int a) {}
 	void jsContextConfig(int w, int h) {}
 #endif
@@ -380,6 +388,9 @@ namespace Rtt
 	{
 		delete fMouseListener;
 		delete fKeyListener;
+
+		// the save queue outlives the Lua state
+		EmscriptenSaveQueue::Instance().ClearListener();
 		delete fRuntime;
 		delete fRuntimeDelegate;
 		delete fPlatform;
@@ -537,11 +548,17 @@ namespace Rtt
 		glewInit();
 #endif
 
+		// images larger than the GL limit are reduced while decoding
+		GLint maxTextureSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+		EmscriptenImageDecoder::SetMaxSize(maxTextureSize, 0);
+
 		fMouseListener = new MouseListener(*fRuntime);
 		fKeyListener = new KeyListener(*fRuntime);
 
 		if (Runtime::kSuccess != fRuntime->LoadApplication(Runtime::kHTML5LaunchOption, fOrientation)) 
 		{
+			EmscriptenSaveQueue::Instance().ClearListener();
 			delete fRuntime;
 			delete fPlatform;
 			return false;
@@ -1161,20 +1178,10 @@ namespace Rtt
 			for (int i = 0; i < fileList.size(); i++)
 			{
 				const std::string& name = fileList[i];
-				FILE* fi = fopen(name.c_str(), "rb");
-				if (fi)
-				{
-					fseek(fi, 0, SEEK_END);
-					int size = ftell(fi);
-					fseek(fi, 0, SEEK_SET);
-					void* buf = malloc(size);
-					fread(buf, 1, size, fi);
-					fclose(fi);
-
-					loadingFonts += jsContextLoadFonts(name.c_str(), buf, size);
+				EmscriptenGlyphAtlas::Instance().AddFontFile(name.c_str());
 
-					free(buf);
-				}
+				// the browser reads the file itself
+				loadingFonts += jsContextLoadFonts(name.c_str());
 			}
 			fAppState = loadingFonts > 0 ? WAIT_FOR_FONTS : INIT_APP;
 			break;
@@ -1207,6 +1214,10 @@ namespace Rtt
 				closeApp = ProcessEvent(event);
 			}
 
+			// deliver prefetched images before the frame which may use them
+			EmscriptenDecodeQueue::Instance().Poll();
+			EmscriptenSaveQueue::Instance().Poll();
+
 			if (fRuntime->IsSuspended() == false)
 			{
 				(*fRuntime)();
@@ -9,6 +9,388 @@
 
 #include "Core/Rtt_Build.h"
 #include "Rtt_EmscriptenCrypto.h"
+#include <string.h>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Merkle-Damgard state shared by MD4/MD5/SHA-1/SHA-2, words are either 32 or 64 bits
+struct HashState
+{
+	union
+	{
+		U32 h32[8];
+		U64 h64[8];
+	};
+	U8 buffer[128];
+	U64 length;		// total bytes
+	size_t used;	// bytes in buffer
+};
+
+struct HashAlgorithm
+{
+	size_t digestLength;
+	size_t blockSize;
+	bool isBigEndian;
+	void (*init)(HashState& s);
+	void (*compress)(HashState& s, const U8 *block);
+};
+
+inline U32 Rotl32(U32 x, int n) { return (x << n) | (x >> (32 - n)); }
+inline U32 Rotr32(U32 x, int n) { return (x >> n) | (x << (32 - n)); }
+inline U64 Rotr64(U64 x, int n) { return (x >> n) | (x << (64 - n)); }
+
+inline U32 LoadLE32(const U8 *p) { return (U32)p[0] | ((U32)p[1] << 8) | ((U32)p[2] << 16) | ((U32)p[3] << 24); }
+inline U32 LoadBE32(const U8 *p) { return ((U32)p[0] << 24) | ((U32)p[1] << 16) | ((U32)p[2] << 8) | (U32)p[3]; }
+inline U64 LoadBE64(const U8 *p) { return ((U64)LoadBE32(p) << 32) | LoadBE32(p + 4); }
+
+// ----------------------------------------------------------------------------
+
+#define MD4_ROUND(f, a, b, c, d, x, s) a = Rotl32(a + (f) + (x), s)
+
+static void MD4Init(HashState& s)
+{
+	s.h32[0] = 0x67452301; s.h32[1] = 0xefcdab89; s.h32[2] = 0x98badcfe; s.h32[3] = 0x10325476;
+}
+
+static void MD4Compress(HashState& s, const U8 *block)
+{
+	U32 x[16];
+	for (int i = 0; i < 16; i++) { x[i] = LoadLE32(block + i * 4); }
+
+	U32 a = s.h32[0], b = s.h32[1], c = s.h32[2], d = s.h32[3];
+
+	for (int i = 0; i < 16; i += 4)
+	{
+		MD4_ROUND((b & c) | (~b & d), a, b, c, d, x[i], 3);
+		MD4_ROUND((a & b) | (~a & c), d, a, b, c, x[i + 1], 7);
+		MD4_ROUND((d & a) | (~d & b), c, d, a, b, x[i + 2], 11);
+		MD4_ROUND((c & d) | (~c & a), b, c, d, a, x[i + 3], 19);
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		MD4_ROUND(((b & c) | (b & d) | (c & d)) + 0x5a827999, a, b, c, d, x[i], 3);
+		MD4_ROUND(((a & b) | (a & c) | (b & c)) + 0x5a827999, d, a, b, c, x[i + 4], 5);
+		MD4_ROUND(((d & a) | (d & b) | (a & b)) + 0x5a827999, c, d, a, b, x[i + 8], 9);
+		MD4_ROUND(((c & d) | (c & a) | (d & a)) + 0x5a827999, b, c, d, a, x[i + 12], 13);
+	}
+	static const int kOrder[4] = { 0, 2, 1, 3 };
+	for (int j = 0; j < 4; j++)
+	{
+		int i = kOrder[j];
+		MD4_ROUND((b ^ c ^ d) + 0x6ed9eba1, a, b, c, d, x[i], 3);
+		MD4_ROUND((a ^ b ^ c) + 0x6ed9eba1, d, a, b, c, x[i + 8], 9);
+		MD4_ROUND((d ^ a ^ b) + 0x6ed9eba1, c, d, a, b, x[i + 4], 11);
+		MD4_ROUND((c ^ d ^ a) + 0x6ed9eba1, b, c, d, a, x[i + 12], 15);
+	}
+
+	s.h32[0] += a; s.h32[1] += b; s.h32[2] += c; s.h32[3] += d;
+}
+
+#undef MD4_ROUND
+
+// ----------------------------------------------------------------------------
+
+static const U32 kMD5K[64] =
+{
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+static const int kMD5Shift[16] = { 7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21 };
+
+static void MD5Compress(HashState& s, const U8 *block)
+{
+	U32 x[16];
+	for (int i = 0; i < 16; i++) { x[i] = LoadLE32(block + i * 4); }
+
+	U32 a = s.h32[0], b = s.h32[1], c = s.h32[2], d = s.h32[3];
+
+	for (int i = 0; i < 64; i++)
+	{
+		U32 f;
+		int g;
+		switch (i >> 4)
+		{
+			case 0: f = d ^ (b & (c ^ d)); g = i; break;
+			case 1: f = c ^ (d & (b ^ c)); g = (5 * i + 1) & 15; break;
+			case 2: f = b ^ c ^ d; g = (3 * i + 5) & 15; break;
+			default: f = c ^ (b | ~d); g = (7 * i) & 15; break;
+		}
+		U32 t = d;
+		d = c;
+		c = b;
+		b = b + Rotl32(a + f + kMD5K[i] + x[g], kMD5Shift[((i >> 4) << 2) | (i & 3)]);
+		a = t;
+	}
+
+	s.h32[0] += a; s.h32[1] += b; s.h32[2] += c; s.h32[3] += d;
+}
+
+// ----------------------------------------------------------------------------
+
+static void SHA1Init(HashState& s)
+{
+	MD4Init(s);
+	s.h32[4] = 0xc3d2e1f0;
+}
+
+static void SHA1Compress(HashState& s, const U8 *block)
+{
+	U32 w[80];
+	for (int i = 0; i < 16; i++) { w[i] = LoadBE32(block + i * 4); }
+	for (int i = 16; i < 80; i++) { w[i] = Rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1); }
+
+	U32 a = s.h32[0], b = s.h32[1], c = s.h32[2], d = s.h32[3], e = s.h32[4];
+
+	for (int i = 0; i < 80; i++)
+	{
+		U32 f, k;
+		if (i < 20) { f = d ^ (b & (c ^ d)); k = 0x5a827999; }
+		else if (i < 40) { f = b ^ c ^ d; k = 0x6ed9eba1; }
+		else if (i < 60) { f = (b & c) | (d & (b | c)); k = 0x8f1bbcdc; }
+		else { f = b ^ c ^ d; k = 0xca62c1d6; }
+
+		U32 t = Rotl32(a, 5) + f + e + k + w[i];
+		e = d;
+		d = c;
+		c = Rotl32(b, 30);
+		b = a;
+		a = t;
+	}
+
+	s.h32[0] += a; s.h32[1] += b; s.h32[2] += c; s.h32[3] += d; s.h32[4] += e;
+}
+
+// ----------------------------------------------------------------------------
+
+static const U32 kSHA256K[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static void SHA224Init(HashState& s)
+{
+	static const U32 kH[8] = { 0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4 };
+	memcpy(s.h32, kH, sizeof(kH));
+}
+
+static void SHA256Init(HashState& s)
+{
+	static const U32 kH[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+	memcpy(s.h32, kH, sizeof(kH));
+}
+
+static void SHA256Compress(HashState& s, const U8 *block)
+{
+	U32 w[64];
+	for (int i = 0; i < 16; i++) { w[i] = LoadBE32(block + i * 4); }
+	for (int i = 16; i < 64; i++)
+	{
+		U32 s0 = Rotr32(w[i - 15], 7) ^ Rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		U32 s1 = Rotr32(w[i - 2], 17) ^ Rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	U32 a = s.h32[0], b = s.h32[1], c = s.h32[2], d = s.h32[3];
+	U32 e = s.h32[4], f = s.h32[5], g = s.h32[6], h = s.h32[7];
+
+	for (int i = 0; i < 64; i++)
+	{
+		U32 t1 = h + (Rotr32(e, 6) ^ Rotr32(e, 11) ^ Rotr32(e, 25)) + (g ^ (e & (f ^ g))) + kSHA256K[i] + w[i];
+		U32 t2 = (Rotr32(a, 2) ^ Rotr32(a, 13) ^ Rotr32(a, 22)) + ((a & b) | (c & (a | b)));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	s.h32[0] += a; s.h32[1] += b; s.h32[2] += c; s.h32[3] += d;
+	s.h32[4] += e; s.h32[5] += f; s.h32[6] += g; s.h32[7] += h;
+}
+
+// ----------------------------------------------------------------------------
+
+static const U64 kSHA512K[80] =
+{
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static void SHA384Init(HashState& s)
+{
+	static const U64 kH[8] =
+	{
+		0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+		0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL,
+	};
+	memcpy(s.h64, kH, sizeof(kH));
+}
+
+static void SHA512Init(HashState& s)
+{
+	static const U64 kH[8] =
+	{
+		0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+		0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+	};
+	memcpy(s.h64, kH, sizeof(kH));
+}
+
+static void SHA512Compress(HashState& s, const U8 *block)
+{
+	U64 w[80];
+	for (int i = 0; i < 16; i++) { w[i] = LoadBE64(block + i * 8); }
+	for (int i = 16; i < 80; i++)
+	{
+		U64 s0 = Rotr64(w[i - 15], 1) ^ Rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+		U64 s1 = Rotr64(w[i - 2], 19) ^ Rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	U64 a = s.h64[0], b = s.h64[1], c = s.h64[2], d = s.h64[3];
+	U64 e = s.h64[4], f = s.h64[5], g = s.h64[6], h = s.h64[7];
+
+	for (int i = 0; i < 80; i++)
+	{
+		U64 t1 = h + (Rotr64(e, 14) ^ Rotr64(e, 18) ^ Rotr64(e, 41)) + (g ^ (e & (f ^ g))) + kSHA512K[i] + w[i];
+		U64 t2 = (Rotr64(a, 28) ^ Rotr64(a, 34) ^ Rotr64(a, 39)) + ((a & b) | (c & (a | b)));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	s.h64[0] += a; s.h64[1] += b; s.h64[2] += c; s.h64[3] += d;
+	s.h64[4] += e; s.h64[5] += f; s.h64[6] += g; s.h64[7] += h;
+}
+
+// ----------------------------------------------------------------------------
+
+// Indexed by MCrypto::Algorithm
+static const HashAlgorithm kAlgorithms[] =
+{
+	{ 16, 64, false, MD4Init, MD4Compress },		// kMD4Algorithm
+	{ 16, 64, false, MD4Init, MD5Compress },		// kMD5Algorithm, same initial state as MD4
+	{ 20, 64, true, SHA1Init, SHA1Compress },		// kSHA1Algorithm
+	{ 28, 64, true, SHA224Init, SHA256Compress },	// kSHA224Algorithm
+	{ 32, 64, true, SHA256Init, SHA256Compress },	// kSHA256Algorithm
+	{ 48, 128, true, SHA384Init, SHA512Compress },	// kSHA384Algorithm
+	{ 64, 128, true, SHA512Init, SHA512Compress },	// kSHA512Algorithm
+};
+
+static const HashAlgorithm* GetAlgorithm(Rtt::MCrypto::Algorithm algorithm)
+{
+	size_t index = (size_t)algorithm;
+	return index < sizeof(kAlgorithms) / sizeof(kAlgorithms[0]) ? &kAlgorithms[index] : NULL;
+}
+
+static void HashInit(const HashAlgorithm& alg, HashState& s)
+{
+	alg.init(s);
+	s.length = 0;
+	s.used = 0;
+}
+
+static void HashUpdate(const HashAlgorithm& alg, HashState& s, const U8 *data, size_t size)
+{
+	s.length += size;
+
+	if (s.used > 0)
+	{
+		size_t n = alg.blockSize - s.used;
+		if (n > size) { n = size; }
+		memcpy(s.buffer + s.used, data, n);
+		s.used += n;
+		data += n;
+		size -= n;
+		if (s.used < alg.blockSize)
+		{
+			return;
+		}
+		alg.compress(s, s.buffer);
+		s.used = 0;
+	}
+
+	// whole blocks straight from the input, no copy
+	for (; size >= alg.blockSize; data += alg.blockSize, size -= alg.blockSize)
+	{
+		alg.compress(s, data);
+	}
+
+	memcpy(s.buffer, data, size);
+	s.used = size;
+}
+
+static void HashFinal(const HashAlgorithm& alg, HashState& s, U8 *digest)
+{
+	// pad with 0x80, zeros and the message length in bits, 64 bit field for 64 byte blocks, 128 bit for 128 byte blocks
+	size_t lengthSize = alg.blockSize / 8;
+	U64 bits = s.length << 3;
+
+	s.buffer[s.used++] = 0x80;
+	if (s.used > alg.blockSize - lengthSize)
+	{
+		memset(s.buffer + s.used, 0, alg.blockSize - s.used);
+		alg.compress(s, s.buffer);
+		s.used = 0;
+	}
+	memset(s.buffer + s.used, 0, alg.blockSize - s.used);
+
+	U8 *p = s.buffer + alg.blockSize - 8;
+	for (int i = 0; i < 8; i++)
+	{
+		p[alg.isBigEndian ? 7 - i : i] = (U8)(bits >> (i * 8));
+	}
+	alg.compress(s, s.buffer);
+
+	for (size_t i = 0; i < alg.digestLength; i++)
+	{
+		if (alg.blockSize == 128)
+		{
+			digest[i] = (U8)(s.h64[i >> 3] >> (56 - ((i & 7) << 3)));
+		}
+		else if (alg.isBigEndian)
+		{
+			digest[i] = (U8)(s.h32[i >> 2] >> (24 - ((i & 3) << 3)));
+		}
+		else
+		{
+			digest[i] = (U8)(s.h32[i >> 2] >> ((i & 3) << 3));
+		}
+	}
+}
+
+} // anonymous namespace
 
 // ----------------------------------------------------------------------------
 
@@ -21,15 +403,64 @@ namespace Rtt
 size_t EmscriptenCrypto::GetDigestLength(Algorithm algorithm) const
 {
 	size_t result = 0;
+	const HashAlgorithm *alg = GetAlgorithm(algorithm);
+	if (alg)
+	{
+		result = alg->digestLength;
+	}
 	return result;
 }
 
 void EmscriptenCrypto::CalculateDigest(Algorithm algorithm, const Rtt::Data<const char> & data, U8 *digest) const
 {
+	const HashAlgorithm *alg = GetAlgorithm(algorithm);
+	if (alg)
+	{
+		HashState s;
+		HashInit(*alg, s);
+		HashUpdate(*alg, s, (const U8 *)data.Get(), data.GetLength());
+		HashFinal(*alg, s, digest);
+	}
 }
 
+// RFC 2104: H((K ^ opad) || H((K ^ ipad) || data)), keys longer than a block are hashed first
 void EmscriptenCrypto::CalculateHMAC(Algorithm algorithm, const Rtt::Data<const char> & key, const Rtt::Data<const char> & data, U8 *digest) const
 {
+	const HashAlgorithm *alg = GetAlgorithm(algorithm);
+	if (!alg)
+	{
+		return;
+	}
+
+	U8 k[128];
+	memset(k, 0, sizeof(k));
+
+	HashState s;
+	if (key.GetLength() > alg->blockSize)
+	{
+		HashInit(*alg, s);
+		HashUpdate(*alg, s, (const U8 *)key.Get(), key.GetLength());
+		HashFinal(*alg, s, k);
+	}
+	else if (key.GetLength() > 0)
+	{
+		memcpy(k, key.Get(), key.GetLength());
+	}
+
+	U8 pad[128];
+	U8 inner[64];
+
+	for (size_t i = 0; i < alg->blockSize; i++) { pad[i] = k[i] ^ 0x36; }
+	HashInit(*alg, s);
+	HashUpdate(*alg, s, pad, alg->blockSize);
+	HashUpdate(*alg, s, (const U8 *)data.Get(), data.GetLength());
+	HashFinal(*alg, s, inner);
+
+	for (size_t i = 0; i < alg->blockSize; i++) { pad[i] = k[i] ^ 0x5c; }
+	HashInit(*alg, s);
+	HashUpdate(*alg, s, pad, alg->blockSize);
+	HashUpdate(*alg, s, inner, alg->digestLength);
+	HashFinal(*alg, s, digest);
 }
 
 #pragma endregion
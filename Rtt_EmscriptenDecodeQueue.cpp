@@ -0,0 +1,409 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenDecodeQueue.h"
+#include "Rtt_EmscriptenBitmapCache.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenPixels.h"
+#include "Rtt_Lua.h"
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#if defined(EMSCRIPTEN)
+#include "emscripten/emscripten.h"
+
+extern "C"
+{
+	// JS ==> C callback
+	void EMSCRIPTEN_KEEPALIVE jsDecodeQueueDone(void* job, U8* data, int width, int height)
+	{
+		Rtt::EmscriptenDecodeQueue::Instance().OnBrowserDecoded(job, data, width, height);
+	}
+
+	extern int jsCanDecodeImages();
+	extern void jsDecodeImage(const char* path, void* job);
+}
+#else
+	int jsCanDecodeImages() { return 0; }
+	void jsDecodeImage(const char* path, void* job) {}
+#endif
+
+namespace Rtt
+{
+
+	// time spent decoding per frame when there are no worker threads
+	static const int kMainThreadBudgetMs = 8;
+
+	EmscriptenDecodeQueue& EmscriptenDecodeQueue::Instance()
+	{
+		static EmscriptenDecodeQueue sQueue;
+		return sQueue;
+	}
+
+	EmscriptenDecodeQueue::EmscriptenDecodeQueue()
+		: fQuit(false)
+		, fBrowserDecode(false)
+	{
+		memset(&fStats, 0, sizeof(fStats));
+	}
+
+	bool EmscriptenDecodeQueue::IsBrowserDecode() const
+	{
+		static int sCanDecode = jsCanDecodeImages();
+		return fBrowserDecode && sCanDecode;
+	}
+
+	EmscriptenDecodeQueue::Stats EmscriptenDecodeQueue::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		return fStats;
+	}
+
+	EmscriptenDecodeQueue::~EmscriptenDecodeQueue()
+	{
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			fQuit = true;
+		}
+		fWorkAvailable.notify_all();
+		for (size_t i = 0; i < fWorkers.size(); i++)
+		{
+			fWorkers[i].join();
+		}
+#endif
+
+		// Lua is gone at exit, listeners are not released
+		for (std::map<std::string, Job*>::iterator it = fJobs.begin(); it != fJobs.end(); ++it)
+		{
+			free(it->second->fData);
+			delete it->second;
+		}
+		for (size_t i = 0; i < fBatches.size(); i++)
+		{
+			delete fBatches[i];
+		}
+	}
+
+	void EmscriptenDecodeQueue::Prefetch(lua_State *L, const std::vector<std::string>& paths, int listenerIndex)
+	{
+		Batch* batch = new Batch();
+		batch->fL = L;
+		batch->fListener = (listenerIndex > 0 && lua_isfunction(L, listenerIndex)) ? CoronaLuaNewRef(L, listenerIndex) : NULL;
+		batch->fTotal = 0;
+		batch->fRemaining = 0;
+		batch->fFailed = 0;
+
+		bool isBrowserDecode = IsBrowserDecode();
+		std::vector<Job*> browserJobs;
+		EmscriptenBitmapCache& cache = EmscriptenBitmapCache::Instance();
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			for (size_t i = 0; i < paths.size(); i++)
+			{
+				// already queued, decoded or cached
+				if (fJobs.find(paths[i]) != fJobs.end() || cache.Contains(paths[i].c_str()))
+				{
+					continue;
+				}
+
+				Job* job = new Job();
+				job->fPath = paths[i];
+				job->fState = isBrowserDecode ? kDecoding : kQueued;
+				job->fBrowser = isBrowserDecode;
+				job->fData = NULL;
+				job->fWidth = 0;
+				job->fHeight = 0;
+				job->fScale = 1;
+				job->fBatch = batch;
+				fJobs[paths[i]] = job;
+				if (isBrowserDecode)
+				{
+					browserJobs.push_back(job);
+				}
+				else
+				{
+					fPending.push_back(paths[i]);
+				}
+				batch->fTotal++;
+				batch->fRemaining++;
+			}
+			fBatches.push_back(batch);
+
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+			if (fWorkers.empty())
+			{
+				// leave one core to the main thread
+				unsigned int n = std::thread::hardware_concurrency();
+				n = (n > 1) ? n - 1 : 1;
+				n = (n > 4) ? 4 : n;
+				for (unsigned int i = 0; i < n; i++)
+				{
+					fWorkers.push_back(std::thread(&EmscriptenDecodeQueue::WorkerMain, this));
+				}
+			}
+#endif
+		}
+
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		fWorkAvailable.notify_all();
+#endif
+
+		// the callbacks come from promises, never from inside jsDecodeImage()
+		for (size_t i = 0; i < browserJobs.size(); i++)
+		{
+			jsDecodeImage(browserJobs[i]->fPath.c_str(), browserJobs[i]);
+		}
+	}
+
+	void EmscriptenDecodeQueue::OnBrowserDecoded(void* ptr, U8* data, int width, int height)
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+
+		Job* job = (Job*) ptr;
+		if (job->fState == kAbandoned)
+		{
+			free(data);
+			delete job;
+			return;
+		}
+
+		if (data == NULL)
+		{
+			// unsupported by the browser, decode it with the wasm decoders
+			fStats.fFallback++;
+			job->fBrowser = false;
+			job->fState = kQueued;
+			fPending.push_front(job->fPath);
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+			fWorkAvailable.notify_one();
+#endif
+			return;
+		}
+
+		EmscriptenPixels::Premultiply(data, data, width * height);
+		float scale = 1;
+		data = EmscriptenImageDecoder::Downscale(data, width, height, scale, EmscriptenImageDecoder::GetMaxSize(false));
+
+		fStats.fBrowser++;
+		job->fData = data;
+		job->fWidth = width;
+		job->fHeight = height;
+		job->fScale = scale;
+		Finish(job);
+	}
+
+	// Decodes the queued path, the lock is released while decoding
+	void EmscriptenDecodeQueue::Decode(const std::string& path, std::unique_lock<std::mutex>& lock)
+	{
+		std::map<std::string, Job*>::iterator it = fJobs.find(path);
+		if (it == fJobs.end() || it->second->fState != kQueued)
+		{
+			return;
+		}
+
+		Job* job = it->second;
+		job->fState = kDecoding;
+
+		lock.unlock();
+		int width = 0, height = 0;
+		float scale = 1;
+		U8* data = EmscriptenImageDecoder::DecodeFile(path.c_str(), width, height, scale, EmscriptenImageDecoder::GetMaxSize(false));
+		lock.lock();
+
+		if (job->fState == kAbandoned)
+		{
+			// taken or cleared meanwhile
+			free(data);
+			delete job;
+			return;
+		}
+
+		fStats.fWasm++;
+		job->fData = data;
+		job->fWidth = width;
+		job->fHeight = height;
+		job->fScale = scale;
+		Finish(job);
+	}
+
+	void EmscriptenDecodeQueue::Finish(Job* job)
+	{
+		job->fState = kDone;
+		if (job->fBatch)
+		{
+			job->fBatch->fRemaining--;
+			job->fBatch->fFailed += (job->fData == NULL) ? 1 : 0;
+			job->fBatch = NULL;
+		}
+	}
+
+	void EmscriptenDecodeQueue::Abandon(Job* job)
+	{
+		job->fState = kAbandoned;
+		if (job->fBatch)
+		{
+			job->fBatch->fRemaining--;
+			job->fBatch = NULL;
+		}
+	}
+
+	void EmscriptenDecodeQueue::WorkerMain()
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+		while (true)
+		{
+			while (!fQuit && fPending.empty())
+			{
+				fWorkAvailable.wait(lock);
+			}
+			if (fQuit)
+			{
+				break;
+			}
+
+			std::string path = fPending.front();
+			fPending.pop_front();
+			Decode(path, lock);
+		}
+	}
+
+	U8* EmscriptenDecodeQueue::Take(const char* path, int& width, int& height, float& scale)
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+
+		std::map<std::string, Job*>::iterator it = fJobs.find(path);
+		if (it == fJobs.end())
+		{
+			return NULL;
+		}
+
+		Job* job = it->second;
+		if (job->fState == kDecoding)
+		{
+			// the main thread never waits for a worker or the browser, the caller decodes it and their result is dropped
+			Abandon(job);
+			fJobs.erase(it);
+			return NULL;
+		}
+
+		// not started yet, decode it here rather than wait for a worker
+		Decode(it->first, lock);
+
+		U8* data = job->fData;
+		width = job->fWidth;
+		height = job->fHeight;
+		scale = job->fScale;
+		fJobs.erase(it);
+		delete job;
+
+		return data;
+	}
+
+	U8* EmscriptenDecodeQueue::Load(const char* path, int& width, int& height, float& scale)
+	{
+		EmscriptenBitmapCache& cache = EmscriptenBitmapCache::Instance();
+		U8* data = cache.Get(path, width, height, scale);
+		if (data)
+		{
+			return data;
+		}
+
+		data = Take(path, width, height, scale);
+		if (data == NULL)
+		{
+			data = EmscriptenImageDecoder::DecodeFile(path, width, height, scale, EmscriptenImageDecoder::GetMaxSize(false));
+
+			std::lock_guard<std::mutex> lock(fMutex);
+			fStats.fSync++;
+		}
+		return data;
+	}
+
+	void EmscriptenDecodeQueue::Poll()
+	{
+		std::vector<Batch*> completed;
+		{
+			std::unique_lock<std::mutex> lock(fMutex);
+
+#if !defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+			// spread the decoding over frames
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			while (!fPending.empty() && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(kMainThreadBudgetMs))
+			{
+				std::string path = fPending.front();
+				fPending.pop_front();
+				Decode(path, lock);
+			}
+#endif
+
+			for (size_t i = 0; i < fBatches.size(); )
+			{
+				if (fBatches[i]->fRemaining == 0)
+				{
+					completed.push_back(fBatches[i]);
+					fBatches.erase(fBatches.begin() + i);
+				}
+				else
+				{
+					i++;
+				}
+			}
+		}
+
+		// listeners are called without the lock, they may create images
+		for (size_t i = 0; i < completed.size(); i++)
+		{
+			Batch* batch = completed[i];
+			if (batch->fListener)
+			{
+				lua_State *L = batch->fL;
+				CoronaLuaNewEvent(L, "imagePrefetch");
+				lua_pushboolean(L, batch->fFailed > 0);
+				lua_setfield(L, -2, "isError");
+				lua_pushinteger(L, batch->fTotal);
+				lua_setfield(L, -2, "count");
+				lua_pushinteger(L, batch->fFailed);
+				lua_setfield(L, -2, "failed");
+				CoronaLuaDispatchEvent(L, batch->fListener, 0);
+				CoronaLuaDeleteRef(L, batch->fListener);
+			}
+			delete batch;
+		}
+	}
+
+	void EmscriptenDecodeQueue::Clear()
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+
+		// images being decoded are freed by their worker or the browser callback
+		fPending.clear();
+		for (std::map<std::string, Job*>::iterator it = fJobs.begin(); it != fJobs.end(); )
+		{
+			Job* job = it->second;
+			if (job->fState == kDecoding)
+			{
+				Abandon(job);
+				fJobs.erase(it++);
+				continue;
+			}
+
+			if (job->fState == kQueued)
+			{
+				Finish(job);
+			}
+			free(job->fData);
+			delete job;
+			fJobs.erase(it++);
+		}
+	}
+
+}
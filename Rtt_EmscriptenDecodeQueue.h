@@ -0,0 +1,125 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include "Corona/CoronaLua.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+// Worker threads exist on native builds and on web builds linked with -pthread,
+// otherwise the queue is drained on the main thread a few milliseconds per frame
+#if !defined(EMSCRIPTEN) || defined(__EMSCRIPTEN_PTHREADS__)
+#define Rtt_EMSCRIPTEN_DECODE_THREADS 1
+#include <thread>
+#endif
+
+namespace Rtt
+{
+
+	// Decodes image files ahead of display.newImage(), see native.setProperty("imagePrefetch", {...}).
+	// LoadFileBitmap takes the decoded pixels instead of decoding on the main thread.
+	class EmscriptenDecodeQueue
+	{
+	public:
+		static EmscriptenDecodeQueue& Instance();
+
+		EmscriptenDecodeQueue();
+		~EmscriptenDecodeQueue();
+
+		// Queues full paths, the listener at listenerIndex (0 for none) gets an "imagePrefetch" event once all are decoded
+		void Prefetch(lua_State *L, const std::vector<std::string>& paths, int listenerIndex);
+
+		// Hands over the premultiplied RGBA pixels of a queued path, decodes it here if no one has started it.
+		// Never waits: returns NULL if the path was not queued or is still being decoded by a worker or the browser,
+		// the caller decodes it and the late result is dropped.
+		U8* Take(const char* path, int& width, int& height, float& scale);
+
+		// Pixels from EmscriptenBitmapCache, Take() or a synchronous decode when the path was not prefetched.
+		// Images are reduced to EmscriptenImageDecoder::GetMaxSize(false), scale receives decoded / original size.
+		U8* Load(const char* path, int& width, int& height, float& scale);
+
+		// Main thread, once per frame: dispatches completed prefetch events
+		void Poll();
+
+		// Frees decoded images nobody has taken, pending ones are dropped
+		void Clear();
+
+		// Prefetched PNG/JPEG/WebP files are decoded by the browser's createImageBitmap when enabled and available,
+		// files the browser fails on fall back to the wasm decoders
+		void SetBrowserDecode(bool enabled) { fBrowserDecode = enabled; }
+		bool IsBrowserDecode() const;
+
+		// JS ==> C, pixels are straight RGBA allocated with malloc, NULL on failure
+		void OnBrowserDecoded(void* job, U8* data, int width, int height);
+
+		struct Stats
+		{
+			int fBrowser;		// decoded by createImageBitmap
+			int fWasm;			// decoded by libpng/libjpeg/... ahead of use
+			int fSync;			// decoded on demand by display.newImage()
+			int fFallback;		// browser failures retried in wasm
+		};
+		Stats GetStats();
+
+	private:
+		struct Batch
+		{
+			lua_State *fL;
+			CoronaLuaRef fListener;
+			int fTotal;
+			int fRemaining;
+			int fFailed;
+		};
+
+		enum JobState
+		{
+			kQueued = 0,
+			kDecoding,
+			kDone,
+			kAbandoned,		// taken or cleared while a worker or the browser decodes it, freed by whoever finishes it
+		};
+
+		struct Job
+		{
+			std::string fPath;
+			JobState fState;
+			bool fBrowser;
+			U8* fData;
+			int fWidth;
+			int fHeight;
+			float fScale;
+			Batch* fBatch;
+		};
+
+		void Decode(const std::string& path, std::unique_lock<std::mutex>& lock);
+		void Finish(Job* job);
+		void Abandon(Job* job);
+		void WorkerMain();
+
+		std::mutex fMutex;
+		std::condition_variable fWorkAvailable;
+		std::map<std::string, Job*> fJobs;
+		std::deque<std::string> fPending;
+		std::vector<Batch*> fBatches;
+		bool fQuit;
+		bool fBrowserDecode;
+		Stats fStats;
+
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		std::vector<std::thread> fWorkers;
+#endif
+	};
+
+}
@@ -0,0 +1,469 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenGlyphAtlas.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#endif
+
+namespace Rtt
+{
+
+	// font name as the canvas renderer sees it: file name without directory and extension
+	static std::string FontKey(const char* path)
+	{
+		const char* name = strrchr(path, '/');
+		name = name ? name + 1 : path;
+		const char* ext = strchr(name, '.');
+		return ext ? std::string(name, ext - name) : std::string(name);
+	}
+
+	static void DecodeUTF8(const char* str, std::vector<U32>& text)
+	{
+		const U8* s = (const U8*) str;
+		while (*s)
+		{
+			U32 ch = *s++;
+			int extra = 0;
+			if (ch >= 0xF0)
+			{
+				ch &= 0x07;
+				extra = 3;
+			}
+			else if (ch >= 0xE0)
+			{
+				ch &= 0x0F;
+				extra = 2;
+			}
+			else if (ch >= 0xC0)
+			{
+				ch &= 0x1F;
+				extra = 1;
+			}
+			for (; extra > 0 && (*s & 0xC0) == 0x80; extra--)
+			{
+				ch = (ch << 6) | (*s++ & 0x3F);
+			}
+			text.push_back(extra == 0 ? ch : '?');
+		}
+	}
+
+	// CJK, kana, hangul and fullwidth forms break between any two characters
+	static bool IsBreakable(U32 ch)
+	{
+		return (ch >= 0x2E80 && ch <= 0x9FFF) || (ch >= 0xAC00 && ch <= 0xD7AF) || (ch >= 0xF900 && ch <= 0xFAFF) || (ch >= 0xFF00 && ch <= 0xFFEF);
+	}
+
+	EmscriptenGlyphAtlas& EmscriptenGlyphAtlas::Instance()
+	{
+		static EmscriptenGlyphAtlas sAtlas;
+		return sAtlas;
+	}
+
+	EmscriptenGlyphAtlas::EmscriptenGlyphAtlas()
+		: fEnabled(false)
+		, fSkyline(NULL)
+		, fResets(0)
+	{
+	}
+
+	EmscriptenGlyphAtlas::~EmscriptenGlyphAtlas()
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		for (std::map<std::string, Font>::iterator it = fFonts.begin(); it != fFonts.end(); ++it)
+		{
+			if (it->second.fFont)
+			{
+				TTF_CloseFont(it->second.fFont);
+			}
+		}
+#endif
+		delete fSkyline;
+	}
+
+	bool EmscriptenGlyphAtlas::IsSupported()
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void EmscriptenGlyphAtlas::AddFontFile(const char* path)
+	{
+		fFontFiles[FontKey(path)] = path;
+	}
+
+	EmscriptenGlyphAtlas::Stats EmscriptenGlyphAtlas::GetStats() const
+	{
+		Stats stats;
+		stats.fGlyphs = (int) fGlyphs.size();
+		stats.fFonts = (int) fFonts.size();
+		stats.fResets = fResets;
+		return stats;
+	}
+
+	// A full page is cleared and refilled with the glyphs in use, it is rare with a few fonts and sizes
+	void EmscriptenGlyphAtlas::Reset()
+	{
+		if (fSkyline)
+		{
+			fResets++;
+		}
+		delete fSkyline;
+		fSkyline = new EmscriptenSkyline(kPageSize, kPageSize);
+		fPage.assign(kPageSize * kPageSize, 0);
+		fGlyphs.clear();
+	}
+
+	const EmscriptenGlyphAtlas::Font* EmscriptenGlyphAtlas::OpenFont(const char* fontName, int size)
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		std::map<std::string, std::string>::const_iterator file = fFontFiles.find(FontKey(fontName));
+		if (file == fFontFiles.end())
+		{
+			return NULL;
+		}
+
+		char key[32];
+		snprintf(key, sizeof(key), ":%d", size);
+		std::string fontKey = file->second + key;
+		std::map<std::string, Font>::iterator it = fFonts.find(fontKey);
+		if (it == fFonts.end())
+		{
+			if (!TTF_WasInit() && TTF_Init() != 0)
+			{
+				Rtt_LogException("TTF_Init failed: %s\n", TTF_GetError());
+				fEnabled = false;
+				return NULL;
+			}
+
+			// a font which fails to open is remembered, it is not retried for every text
+			Font font;
+			font.fFont = TTF_OpenFont(file->second.c_str(), size);
+			font.fId = (int) fFonts.size();
+			if (font.fFont == NULL)
+			{
+				Rtt_LogException("Failed to open font %s: %s\n", file->second.c_str(), TTF_GetError());
+			}
+			it = fFonts.insert(std::make_pair(fontKey, font)).first;
+		}
+		return it->second.fFont ? &it->second : NULL;
+#else
+		return NULL;
+#endif
+	}
+
+	bool EmscriptenGlyphAtlas::GetGlyph(const Font& font, U32 ch, Glyph& glyph)
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		// this SDL_ttf takes UCS-2, characters beyond the BMP are drawn as '?'
+		Uint16 code = (ch > 0xFFFF || !TTF_GlyphIsProvided(font.fFont, (Uint16) ch)) ? '?' : (Uint16) ch;
+		U64 key = ((U64) font.fId << 32) | code;
+		std::map<U64, Glyph>::const_iterator it = fGlyphs.find(key);
+		if (it != fGlyphs.end())
+		{
+			glyph = it->second;
+			return true;
+		}
+
+		int minx, maxx, miny, maxy, advance;
+		if (TTF_GlyphMetrics(font.fFont, code, &minx, &maxx, &miny, &maxy, &advance) != 0)
+		{
+			return false;
+		}
+
+		memset(&glyph, 0, sizeof(glyph));
+		glyph.fLeft = minx;
+		glyph.fTop = TTF_FontAscent(font.fFont) - maxy;
+		glyph.fAdvance = advance;
+
+		// shaded glyphs are 8-bit with palette index 0..255 from background to foreground, i.e. the coverage
+		SDL_Color white = { 255, 255, 255, 255 };
+		SDL_Color black = { 0, 0, 0, 255 };
+		SDL_Surface* surface = (code == ' ') ? NULL : TTF_RenderGlyph_Shaded(font.fFont, code, white, black);
+		if (surface && surface->w > 0 && surface->h > 0 && surface->w < kPageSize && surface->h < kPageSize)
+		{
+			// 1px gap so glyphs never bleed into each other
+			int x = 0;
+			int y = 0;
+			if (fSkyline == NULL || !fSkyline->Insert(surface->w + 1, surface->h + 1, x, y))
+			{
+				Reset();
+				fSkyline->Insert(surface->w + 1, surface->h + 1, x, y);
+			}
+
+			glyph.fX = x;
+			glyph.fY = y;
+			glyph.fWidth = surface->w;
+			glyph.fHeight = surface->h;
+
+			SDL_LockSurface(surface);
+			for (int row = 0; row < surface->h; row++)
+			{
+				memcpy(&fPage[(y + row) * kPageSize + x], (const U8*) surface->pixels + row * surface->pitch, surface->w);
+			}
+			SDL_UnlockSurface(surface);
+		}
+		if (surface)
+		{
+			SDL_FreeSurface(surface);
+		}
+
+		fGlyphs[key] = glyph;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// spaces before a wrap are not drawn, they would shift right and center aligned lines
+	static void PushWrapped(const std::vector<U32>& text, const std::vector<int>& advances, std::vector<EmscriptenGlyphAtlas::Line>& lines, size_t begin, size_t end, int lineWidth)
+	{
+		for (; end > begin && text[end - 1] == ' '; end--)
+		{
+			lineWidth -= advances[end - 1];
+		}
+		EmscriptenGlyphAtlas::Line line = { begin, end, lineWidth };
+		lines.push_back(line);
+	}
+
+	// Greedy wrap over words, spaces and breakable characters, the same rules as the canvas renderer
+	void EmscriptenGlyphAtlas::Layout(const std::vector<U32>& text, const std::vector<int>& advances, int width, std::vector<Line>& lines)
+	{
+		size_t n = text.size();
+		size_t begin = 0;
+		int lineWidth = 0;
+
+		size_t i = 0;
+		while (i <= n)
+		{
+			if (i == n || text[i] == '\n')
+			{
+				// explicit newline, trailing spaces are kept as typed
+				Line line = { begin, i, lineWidth };
+				lines.push_back(line);
+				begin = ++i;
+				lineWidth = 0;
+				continue;
+			}
+
+			size_t end = i + 1;
+			if (text[i] != ' ' && !IsBreakable(text[i]))
+			{
+				while (end < n && text[end] != ' ' && text[end] != '\n' && !IsBreakable(text[end]))
+				{
+					end++;
+				}
+			}
+
+			int tokenWidth = 0;
+			for (size_t k = i; k < end; k++)
+			{
+				tokenWidth += advances[k];
+			}
+
+			if (width <= 0 || lineWidth + tokenWidth <= width)
+			{
+				lineWidth += tokenWidth;
+			}
+			else
+			{
+				if (i > begin)
+				{
+					PushWrapped(text, advances, lines, begin, i, lineWidth);
+					begin = i;
+					lineWidth = 0;
+				}
+
+				if (text[i] == ' ')
+				{
+					// the space which overflows ends the line
+					begin = end;
+				}
+				else if (tokenWidth <= width)
+				{
+					lineWidth = tokenWidth;
+				}
+				else
+				{
+					// a word wider than the text box is split between characters
+					for (size_t k = i; k < end; k++)
+					{
+						if (lineWidth + advances[k] > width && k > begin)
+						{
+							PushWrapped(text, advances, lines, begin, k, lineWidth);
+							begin = k;
+							lineWidth = 0;
+						}
+						lineWidth += advances[k];
+					}
+				}
+			}
+			i = end;
+		}
+	}
+
+	// Decodes and wraps str, NULL if the backend is off or the font has no file
+	const EmscriptenGlyphAtlas::Font* EmscriptenGlyphAtlas::LayoutText(const char* str, const char* fontName, float size, int width, std::vector<U32>& text, std::vector<Line>& lines)
+	{
+		if (!fEnabled || str == NULL || fontName == NULL)
+		{
+			return NULL;
+		}
+
+		const Font* font = OpenFont(fontName, PixelSize(size));
+		if (font == NULL)
+		{
+			return NULL;
+		}
+
+		DecodeUTF8(str, text);
+
+		std::vector<int> advances(text.size(), 0);
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			Glyph glyph;
+			if (text[i] != '\n' && GetGlyph(*font, text[i], glyph))
+			{
+				advances[i] = glyph.fAdvance;
+			}
+		}
+
+		Layout(text, advances, width, lines);
+		return font;
+	}
+
+	bool EmscriptenGlyphAtlas::Measure(const char* str, const char* fontName, float size, int width, int& outWidth, int& outHeight)
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		std::vector<U32> text;
+		std::vector<Line> lines;
+		const Font* font = LayoutText(str, fontName, size, width, text, lines);
+		if (font == NULL)
+		{
+			return false;
+		}
+
+		outWidth = 0;
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			outWidth = std::max(outWidth, lines[i].fWidth);
+		}
+		outHeight = (int) lines.size() * TTF_FontLineSkip(font->fFont);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool EmscriptenGlyphAtlas::GetFontMetrics(const char* fontName, float size, int& ascent, int& descent, int& height, int& lineSkip)
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		const Font* font = (fEnabled && fontName) ? OpenFont(fontName, PixelSize(size)) : NULL;
+		if (font == NULL)
+		{
+			return false;
+		}
+
+		ascent = TTF_FontAscent(font->fFont);
+		descent = TTF_FontDescent(font->fFont);
+		height = TTF_FontHeight(font->fFont);
+		lineSkip = TTF_FontLineSkip(font->fFont);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	U8* EmscriptenGlyphAtlas::Render(const char* str, const char* fontName, float size, int width, int height, const char* alignment, int& outWidth, int& outHeight)
+	{
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+		std::vector<U32> text;
+		std::vector<Line> lines;
+		const Font* font = LayoutText(str, fontName, size, width, text, lines);
+		if (font == NULL)
+		{
+			return NULL;
+		}
+
+		int w = width;
+		if (w <= 0)
+		{
+			for (size_t i = 0; i < lines.size(); i++)
+			{
+				w = std::max(w, lines[i].fWidth);
+			}
+		}
+		int lineSkip = TTF_FontLineSkip(font->fFont);
+		int h = height > 0 ? height : (int) lines.size() * lineSkip;
+
+		// lines are aligned in the requested width, rows are padded like the canvas renderer's
+		int boxWidth = w;
+		w = (std::max(w, 1) + 3) & ~3;
+		h = std::max(h, 1);
+
+		U8* data = (U8*) calloc(w * h, 1);
+		if (data == NULL)
+		{
+			return NULL;
+		}
+
+		bool isRight = alignment && strcmp(alignment, "right") == 0;
+		bool isCenter = alignment && strcmp(alignment, "center") == 0;
+		for (size_t l = 0; l < lines.size(); l++)
+		{
+			const Line& line = lines[l];
+			int penX = isRight ? boxWidth - line.fWidth : (isCenter ? (boxWidth - line.fWidth) / 2 : 0);
+			int penY = (int) l * lineSkip;
+			for (size_t i = line.fBegin; i < line.fEnd; i++)
+			{
+				// the page may have been reset by a later glyph of this text, look it up again
+				Glyph glyph;
+				if (!GetGlyph(*font, text[i], glyph))
+				{
+					continue;
+				}
+
+				int x0 = penX + glyph.fLeft;
+				int y0 = penY + glyph.fTop;
+				for (int row = std::max(0, -y0); row < glyph.fHeight && y0 + row < h; row++)
+				{
+					const U8* src = &fPage[(glyph.fY + row) * kPageSize + glyph.fX];
+					U8* dst = data + (y0 + row) * w;
+					for (int col = std::max(0, -x0); col < glyph.fWidth && x0 + col < w; col++)
+					{
+						// overlapping glyphs keep the stronger coverage
+						U8 a = src[col];
+						if (a > dst[x0 + col])
+						{
+							dst[x0 + col] = a;
+						}
+					}
+				}
+				penX += glyph.fAdvance;
+			}
+		}
+
+		outWidth = w;
+		outHeight = h;
+		return data;
+#else
+		return NULL;
+#endif
+	}
+
+}
@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include "Rtt_EmscriptenSkyline.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct _TTF_Font;
+
+namespace Rtt
+{
+
+	// Native text backend, enabled with native.setProperty("textRenderer", "native") in builds
+	// compiled with Rtt_EMSCRIPTEN_NATIVE_TEXT (SDL_ttf, -s USE_SDL_TTF=2).
+	// Glyphs are rasterized from the font files found at startup and kept in one shared 8-bit atlas page in memory,
+	// so changing a text only copies cached glyphs into its bitmap, without the canvas and getImageData.
+	// Every text object still uploads a texture of its own: sampling the page directly would need glyph quads
+	// from the text display object in librtt. Fonts without a file, like native.systemFont, are still drawn by the browser canvas.
+	class EmscriptenGlyphAtlas
+	{
+	public:
+		struct Stats
+		{
+			int fGlyphs;
+			int fFonts;
+			int fResets;
+		};
+
+		// characters [fBegin, fEnd) of a laid out text
+		struct Line
+		{
+			size_t fBegin;
+			size_t fEnd;
+			int fWidth;
+		};
+
+		static EmscriptenGlyphAtlas& Instance();
+
+		EmscriptenGlyphAtlas();
+		~EmscriptenGlyphAtlas();
+
+		// false if the build has no native text support
+		static bool IsSupported();
+
+		// Whole pixel font size, the one rounding rule of both text backends and their caches
+		static int PixelSize(float size) { return (int) (size + 0.5f); }
+
+		void SetEnabled(bool enabled) { fEnabled = enabled && IsSupported(); }
+		bool IsEnabled() const { return fEnabled; }
+
+		// .ttf/.otf found at startup, found by its file name without extension
+		void AddFontFile(const char* path);
+
+		// Returns a malloc'ed kMask bitmap of the wrapped text,
+		// NULL if the backend is off or the font has no file
+		U8* Render(const char* str, const char* fontName, float size, int width, int height, const char* alignment, int& outWidth, int& outHeight);
+
+		// Size of the wrapped text without drawing it, false when Render() would return NULL
+		bool Measure(const char* str, const char* fontName, float size, int width, int& outWidth, int& outHeight);
+
+		// Font table metrics in pixels, descent is negative
+		bool GetFontMetrics(const char* fontName, float size, int& ascent, int& descent, int& height, int& lineSkip);
+
+		Stats GetStats() const;
+
+		// Wraps text into lines no wider than width pixels, width <= 0 wraps at '\n' only.
+		// advances[i] is the advance of text[i], the same rules as the canvas renderer.
+		static void Layout(const std::vector<U32>& text, const std::vector<int>& advances, int width, std::vector<Line>& lines);
+
+	private:
+		enum
+		{
+			kPageSize = 1024,
+		};
+
+		struct Glyph
+		{
+			S16 fX;
+			S16 fY;
+			S16 fWidth;
+			S16 fHeight;
+			S16 fLeft;
+			S16 fTop;
+			S16 fAdvance;
+		};
+
+		struct Font
+		{
+			_TTF_Font* fFont;
+			int fId;
+		};
+
+		const Font* OpenFont(const char* fontName, int size);
+		bool GetGlyph(const Font& font, U32 ch, Glyph& glyph);
+		void Reset();
+		const Font* LayoutText(const char* str, const char* fontName, float size, int width, std::vector<U32>& text, std::vector<Line>& lines);
+
+		bool fEnabled;
+		std::map<std::string, std::string> fFontFiles;
+		std::map<std::string, Font> fFonts;
+		std::map<U64, Glyph> fGlyphs;
+		std::vector<U8> fPage;
+		EmscriptenSkyline* fSkyline;
+		int fResets;
+	};
+
+}
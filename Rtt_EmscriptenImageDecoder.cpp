@@ -0,0 +1,744 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenPixels.h"
+#include "Display/Rtt_PlatformBitmap.h"
+#include "Rtt_BitmapUtils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <vector>
+#include "png.h"
+
+extern "C"
+{
+#include "jpeglib.h"
+}
+
+#if defined(Rtt_EMSCRIPTEN_WEBP)
+#include "webp/decode.h"
+#endif
+
+namespace Rtt
+{
+
+	EmscriptenImageDecoder::ImageType EmscriptenImageDecoder::Sniff(FILE* f)
+	{
+		static const U8 kPNGMagic[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		static const U8 kKTXMagic[] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+		static const U8 kKTX2Magic[] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		U8 magic[12];
+		memset(magic, 0, sizeof(magic));
+
+		long pos = ftell(f);
+		size_t n = fread(magic, 1, sizeof(magic), f);
+		fseek(f, pos, SEEK_SET);
+
+		if (n >= 8 && memcmp(magic, kPNGMagic, 8) == 0)
+		{
+			return kPNG;
+		}
+		if (n >= 3 && magic[0] == 0xFF && magic[1] == 0xD8 && magic[2] == 0xFF)
+		{
+			return kJPEG;
+		}
+		if (n >= 2 && magic[0] == 'B' && magic[1] == 'M')
+		{
+			return kBMP;
+		}
+		if (n >= 12 && memcmp(magic, "RIFF", 4) == 0 && memcmp(magic + 8, "WEBP", 4) == 0)
+		{
+			return kWebP;
+		}
+		if (n >= 12 && memcmp(magic, kKTXMagic, 12) == 0)
+		{
+			return kKTX;
+		}
+		if (n >= 12 && memcmp(magic, kKTX2Magic, 12) == 0)
+		{
+			return kKTX2;
+		}
+		return kUnknown;
+	}
+
+	static int sHardMaxSize = 0;
+	static int sSoftMaxSize = 0;
+
+	void EmscriptenImageDecoder::SetMaxSize(int hardLimit, int softLimit)
+	{
+		sHardMaxSize = hardLimit;
+		sSoftMaxSize = softLimit;
+	}
+
+	int EmscriptenImageDecoder::GetMaxSize(bool isFullResolution)
+	{
+		if (isFullResolution || sSoftMaxSize <= 0)
+		{
+			return sHardMaxSize;
+		}
+		return (sHardMaxSize > 0 && sHardMaxSize < sSoftMaxSize) ? sHardMaxSize : sSoftMaxSize;
+	}
+
+	// Averages factor x factor blocks of premultiplied RGBA, fed one source row at a time.
+	// Partial blocks at the right and bottom edges are averaged over the pixels they have.
+	class BoxFilter
+	{
+	public:
+		BoxFilter(int srcWidth, int srcHeight, int factor, U8* dst)
+			: fSums(((srcWidth + factor - 1) / factor) * 4, 0)
+			, fSrcWidth(srcWidth)
+			, fSrcHeight(srcHeight)
+			, fFactor(factor)
+			, fRow(0)
+			, fRowsInBlock(0)
+			, fDst(dst)
+		{
+		}
+
+		static int Reduce(int size, int factor) { return (size + factor - 1) / factor; }
+
+		void AddRow(const U8* row)
+		{
+			U32* sums = &fSums[0];
+			for (int x = 0; x < fSrcWidth; x++)
+			{
+				U32* sum = sums + (x / fFactor) * 4;
+				sum[0] += row[0];
+				sum[1] += row[1];
+				sum[2] += row[2];
+				sum[3] += row[3];
+				row += 4;
+			}
+			fRow++;
+			fRowsInBlock++;
+
+			if (fRowsInBlock == fFactor || fRow == fSrcHeight)
+			{
+				int dstWidth = Reduce(fSrcWidth, fFactor);
+				for (int x = 0; x < dstWidth; x++)
+				{
+					int columns = fSrcWidth - x * fFactor;
+					columns = columns < fFactor ? columns : fFactor;
+					U32 n = columns * fRowsInBlock;
+					for (int c = 0; c < 4; c++)
+					{
+						fDst[x * 4 + c] = (U8)((sums[x * 4 + c] + n / 2) / n);
+					}
+				}
+				memset(sums, 0, fSums.size() * sizeof(U32));
+				fDst += dstWidth * 4;
+				fRowsInBlock = 0;
+			}
+		}
+
+	private:
+		std::vector<U32> fSums;
+		int fSrcWidth;
+		int fSrcHeight;
+		int fFactor;
+		int fRow;
+		int fRowsInBlock;
+		U8* fDst;
+	};
+
+	// Reduces a premultiplied RGBA image, src is freed
+	static U8* Reduce(U8* src, int& width, int& height, int factor)
+	{
+		int w = BoxFilter::Reduce(width, factor);
+		int h = BoxFilter::Reduce(height, factor);
+		U8* dst = (U8*) malloc(w * h * 4);
+		if (dst)
+		{
+			BoxFilter filter(width, height, factor, dst);
+			for (int y = 0; y < height; y++)
+			{
+				filter.AddRow(src + y * width * 4);
+			}
+			width = w;
+			height = h;
+		}
+		free(src);
+		return dst;
+	}
+
+	// Image size from the JPEG frame header, the file position is restored
+	static bool ReadJPEGSize(FILE* f, int& width, int& height)
+	{
+		long pos = ftell(f);
+		bool found = false;
+		U8 b[8];
+
+		fseek(f, 2, SEEK_SET);		// skip SOI
+		while (fread(b, 1, 4, f) == 4 && b[0] == 0xFF)
+		{
+			int marker = b[1];
+			int length = (b[2] << 8) | b[3];
+
+			// SOF0..SOF15, except DHT, JPG and DAC
+			if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+			{
+				if (fread(b, 1, 5, f) == 5)
+				{
+					height = (b[1] << 8) | b[2];
+					width = (b[3] << 8) | b[4];
+					found = width > 0 && height > 0;
+				}
+				break;
+			}
+			if (marker == 0xD9 || marker == 0xDA || length < 2)
+			{
+				break;
+			}
+			fseek(f, length - 2, SEEK_CUR);
+		}
+
+		fseek(f, pos, SEEK_SET);
+		return found;
+	}
+
+	// Image size from the PNG IHDR chunk, the file position is restored
+	static bool ReadPNGSize(FILE* f, int& width, int& height)
+	{
+		long pos = ftell(f);
+		U8 b[24];
+		bool found = fread(b, 1, sizeof(b), f) == sizeof(b) && memcmp(b + 12, "IHDR", 4) == 0;
+		if (found)
+		{
+			width = (b[16] << 24) | (b[17] << 16) | (b[18] << 8) | b[19];
+			height = (b[20] << 24) | (b[21] << 16) | (b[22] << 8) | b[23];
+		}
+		fseek(f, pos, SEEK_SET);
+		return found;
+	}
+
+	static int ReductionFactor(int width, int height, int maxSize)
+	{
+		int size = width > height ? width : height;
+		return (maxSize > 0 && size > maxSize) ? (size + maxSize - 1) / maxSize : 1;
+	}
+
+	U8* EmscriptenImageDecoder::Downscale(U8* pixels, int& width, int& height, float& scale, int maxSize)
+	{
+		int sourceWidth = width;
+		int factor = ReductionFactor(width, height, maxSize);
+		if (factor > 1)
+		{
+			pixels = Reduce(pixels, width, height, factor);
+		}
+		scale = (float) width / (float) sourceWidth;
+		return pixels;
+	}
+
+	U8* EmscriptenImageDecoder::DecodeFile(const char* path, int& width, int& height, float& scale, int maxSize, bool premultiply)
+	{
+		FILE* f = fopen(path, "rb");
+		if (f == NULL)
+		{
+			return NULL;
+		}
+
+		// the decoder is picked by the content, the extension may be in any case or missing
+		U8* pixels = NULL;
+		bool isPremultiplied = false;
+		int sourceWidth = 0;
+		int sourceHeight = 0;
+		switch (Sniff(f))
+		{
+			case kBMP:
+			{
+				PlatformBitmap::Format format;
+				pixels = bitmapUtil::loadBMP(path, width, height, format);
+				break;
+			}
+
+			case kPNG:
+			{
+				int factor = ReadPNGSize(f, sourceWidth, sourceHeight) ? ReductionFactor(sourceWidth, sourceHeight, maxSize) : 1;
+				pixels = DecodePNG(f, width, height, factor, premultiply);
+				isPremultiplied = premultiply;
+				break;
+			}
+
+			case kJPEG:
+			{
+				// the largest DCT scaling within the reduction, the box filter below does the rest
+				int denom = 1;
+				if (ReadJPEGSize(f, sourceWidth, sourceHeight))
+				{
+					int factor = ReductionFactor(sourceWidth, sourceHeight, maxSize);
+					while (denom < 8 && denom * 2 <= factor)
+					{
+						denom *= 2;
+					}
+				}
+
+				// decoded straight to RGBA, for some reason RGB images are rendered incorrectly
+				pixels = DecodeJPEG(f, width, height, denom);
+				isPremultiplied = true;		// opaque
+				break;
+			}
+
+			case kWebP:
+				pixels = DecodeWebP(f, width, height);
+				break;
+
+			case kKTX:
+			case kKTX2:
+				pixels = DecodeKTX(f, width, height);
+				break;
+
+			default:
+				Rtt_LogException("Failed to load %s, unknown image format\n", path);
+				break;
+		}
+		fclose(f);
+
+		if (pixels == NULL)
+		{
+			return NULL;
+		}
+
+		if (sourceWidth == 0)
+		{
+			sourceWidth = width;
+			sourceHeight = height;
+		}
+
+		if (premultiply && !isPremultiplied)
+		{
+			// premultiple alpha
+			EmscriptenPixels::Premultiply(pixels, pixels, width * height);
+		}
+
+		// formats without reduced decoding
+		int factor = ReductionFactor(width, height, maxSize);
+		if (factor > 1)
+		{
+			pixels = Reduce(pixels, width, height, factor);
+		}
+
+		scale = (float) width / (float) sourceWidth;
+		return pixels;
+	}
+
+	U8* EmscriptenImageDecoder::DecodePNG(FILE* f, int& width, int& height, int factor, bool premultiply)
+	{
+		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+		png_infop info = png ? png_create_info_struct(png) : NULL;
+		if (info == NULL)
+		{
+			png_destroy_read_struct(&png, NULL, NULL);
+			return NULL;
+		}
+
+		// volatile, they are read after longjmp.
+		// png_error() skips destructors, nothing with one may live on the stack below setjmp
+		U8* volatile pixels = NULL;
+		U8* volatile row = NULL;
+		png_bytep* volatile rows = NULL;
+		BoxFilter* volatile filter = NULL;
+
+		if (setjmp(png_jmpbuf(png)))
+		{
+			png_destroy_read_struct(&png, &info, NULL);
+			delete filter;
+			free(rows);
+			free(row);
+			free(pixels);
+			return NULL;
+		}
+
+		png_init_io(png, f);
+		png_read_info(png, info);
+
+		png_uint_32 w, h;
+		int bitDepth, colorType, interlace;
+		png_get_IHDR(png, info, &w, &h, &bitDepth, &colorType, &interlace, NULL, NULL);
+
+		// everything to 8 bit RGBA
+		if (colorType == PNG_COLOR_TYPE_PALETTE)
+		{
+			png_set_palette_to_rgb(png);
+		}
+		if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
+		{
+			png_set_expand_gray_1_2_4_to_8(png);
+		}
+		if (png_get_valid(png, info, PNG_INFO_tRNS))
+		{
+			png_set_tRNS_to_alpha(png);
+		}
+		if (bitDepth == 16)
+		{
+			png_set_strip_16(png);
+		}
+		if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+		{
+			png_set_gray_to_rgb(png);
+		}
+		png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+
+		int passes = png_set_interlace_handling(png);
+		png_read_update_info(png, info);
+
+		width = (int) w;
+		height = (int) h;
+		if (passes > 1)
+		{
+			// interlaced rows are only complete after the last pass, decode the full image
+			pixels = (U8*) malloc(width * height * 4);
+			rows = (png_bytep*) malloc(height * sizeof(png_bytep));
+			if (pixels == NULL || rows == NULL)
+			{
+				png_error(png, "out of memory");
+			}
+
+			for (int y = 0; y < height; y++)
+			{
+				rows[y] = pixels + y * width * 4;
+			}
+			png_read_image(png, rows);
+			free(rows);
+			rows = NULL;
+			if (premultiply)
+			{
+				EmscriptenPixels::Premultiply(pixels, pixels, width * height);
+			}
+
+			if (factor > 1)
+			{
+				pixels = Reduce(pixels, width, height, factor);
+			}
+		}
+		else
+		{
+			int dstWidth = BoxFilter::Reduce(width, factor);
+			int dstHeight = BoxFilter::Reduce(height, factor);
+			pixels = (U8*) malloc(dstWidth * dstHeight * 4);
+			row = (U8*) malloc(width * 4);
+			if (pixels == NULL || row == NULL)
+			{
+				png_error(png, "out of memory");
+			}
+
+			// factor 1 decodes straight into the bitmap, otherwise rows are filtered as they come
+			filter = new BoxFilter(width, height, factor, pixels);
+			for (int y = 0; y < height; y++)
+			{
+				U8* dst = (factor == 1) ? pixels + y * width * 4 : row;
+				png_read_row(png, dst, NULL);
+				if (premultiply)
+				{
+					EmscriptenPixels::Premultiply(dst, dst, width);
+				}
+				if (factor > 1)
+				{
+					filter->AddRow(dst);
+				}
+			}
+			delete filter;
+			filter = NULL;
+			width = dstWidth;
+			height = dstHeight;
+		}
+
+		png_read_end(png, NULL);
+		png_destroy_read_struct(&png, &info, NULL);
+		free(row);
+
+		return pixels;
+	}
+
+	// libjpeg calls exit() on errors by default, jump back to the decoder instead
+	struct JPEGErrorManager
+	{
+		jpeg_error_mgr pub;
+		jmp_buf jump;
+	};
+
+	static void JPEGErrorExit(j_common_ptr cinfo)
+	{
+		char msg[JMSG_LENGTH_MAX];
+		(*cinfo->err->format_message)(cinfo, msg);
+		Rtt_LogException("JPEG decode failed: %s\n", msg);
+
+		JPEGErrorManager* err = (JPEGErrorManager*) cinfo->err;
+		longjmp(err->jump, 1);
+	}
+
+	U8* EmscriptenImageDecoder::DecodeJPEG(FILE* f, int& width, int& height, int scaleDenom)
+	{
+		jpeg_decompress_struct cinfo;
+		JPEGErrorManager jerr;
+
+		// volatile, they are read after longjmp
+		U8* volatile pixels = NULL;
+		U8* volatile row = NULL;
+
+		cinfo.err = jpeg_std_error(&jerr.pub);
+		jerr.pub.error_exit = JPEGErrorExit;
+		if (setjmp(jerr.jump))
+		{
+			jpeg_destroy_decompress(&cinfo);
+			free(row);
+			free(pixels);
+			return NULL;
+		}
+
+		jpeg_create_decompress(&cinfo);
+		jpeg_stdio_src(&cinfo, f);
+		jpeg_read_header(&cinfo, TRUE);
+
+		// Adobe CMYK is kept as CMYK and converted below, everything else is converted to RGB by libjpeg
+		bool isCMYK = cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK;
+		cinfo.out_color_space = isCMYK ? JCS_CMYK : JCS_RGB;
+
+		if (scaleDenom == 2 || scaleDenom == 4 || scaleDenom == 8)
+		{
+			cinfo.scale_num = 1;
+			cinfo.scale_denom = scaleDenom;
+		}
+
+		jpeg_start_decompress(&cinfo);
+
+		width = cinfo.output_width;
+		height = cinfo.output_height;
+		int components = cinfo.output_components;
+
+		// the image is decoded one scanline at a time into the final RGBA buffer
+		pixels = (U8*) malloc(width * height * 4);
+		row = (U8*) malloc(width * components);
+		if (pixels == NULL || row == NULL)
+		{
+			(*cinfo.err->error_exit)((j_common_ptr) &cinfo);
+		}
+
+		U8* dst = pixels;
+		while (cinfo.output_scanline < cinfo.output_height)
+		{
+			JSAMPROW rows[1] = { row };
+			jpeg_read_scanlines(&cinfo, rows, 1);
+
+			if (isCMYK)
+			{
+				// Adobe writes inverted CMYK
+				const U8* src = row;
+				for (int x = 0; x < width; x++)
+				{
+					dst[x * 4 + 0] = (U8)((src[0] * src[3] + 127) / 255);
+					dst[x * 4 + 1] = (U8)((src[1] * src[3] + 127) / 255);
+					dst[x * 4 + 2] = (U8)((src[2] * src[3] + 127) / 255);
+					dst[x * 4 + 3] = 255;
+					src += 4;
+				}
+			}
+			else
+			{
+				EmscriptenPixels::ExpandRGBToRGBA(dst, row, width);
+			}
+			dst += width * 4;
+		}
+
+		jpeg_finish_decompress(&cinfo);
+		jpeg_destroy_decompress(&cinfo);
+		free(row);
+
+		return pixels;
+	}
+
+	U8* EmscriptenImageDecoder::DecodeWebP(FILE* f, int& width, int& height)
+	{
+#if defined(Rtt_EMSCRIPTEN_WEBP)
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+
+		U8* data = (U8*) malloc(size);
+		if (data == NULL || fread(data, 1, size, f) != (size_t) size)
+		{
+			free(data);
+			return NULL;
+		}
+
+		U8* pixels = NULL;
+		if (WebPGetInfo(data, size, &width, &height))
+		{
+			// decoded straight into a malloc'ed buffer, WebPFree is not needed
+			size_t stride = width * 4;
+			pixels = (U8*) malloc(stride * height);
+			if (pixels && WebPDecodeRGBAInto(data, size, pixels, stride * height, (int) stride) == NULL)
+			{
+				free(pixels);
+				pixels = NULL;
+			}
+		}
+		free(data);
+		return pixels;
+#else
+		Rtt_LogException("WebP images are not supported by this build\n");
+		return NULL;
+#endif
+	}
+
+	// GL / Vulkan format constants used by KTX headers
+	enum
+	{
+		kGL_UNSIGNED_BYTE = 0x1401,
+		kGL_RGB = 0x1907,
+		kGL_RGBA = 0x1908,
+
+		kVK_FORMAT_R8G8B8_UNORM = 23,
+		kVK_FORMAT_R8G8B8_SRGB = 29,
+		kVK_FORMAT_R8G8B8A8_UNORM = 37,
+		kVK_FORMAT_R8G8B8A8_SRGB = 43,
+
+		// size limit when the GL limit is not known yet
+		kKTXMaxSize = 16384,
+	};
+
+	U8* EmscriptenImageDecoder::DecodeKTX(FILE* f, int& width, int& height)
+	{
+		ImageType type = Sniff(f);
+		fseek(f, 12, SEEK_SET);
+
+		int components = 0;
+		size_t rowAlign = 1;
+		U32 pixelWidth = 0, pixelHeight = 0;
+		U64 offset = 0;
+		if (type == kKTX)
+		{
+			// endianness, glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat,
+			// pixelWidth, pixelHeight, pixelDepth, numberOfArrayElements, numberOfFaces, numberOfMipmapLevels, bytesOfKeyValueData
+			U32 h[13];
+			if (fread(h, sizeof(h), 1, f) != 1 || h[0] != 0x04030201)
+			{
+				Rtt_LogException("KTX: unsupported endianness\n");
+				return NULL;
+			}
+
+			if (h[1] == kGL_UNSIGNED_BYTE && h[3] == kGL_RGBA)
+			{
+				components = 4;
+			}
+			else if (h[1] == kGL_UNSIGNED_BYTE && h[3] == kGL_RGB)
+			{
+				components = 3;
+			}
+			else
+			{
+				Rtt_LogException("KTX: glInternalFormat 0x%X is not supported, only uncompressed RGBA8/RGB8 textures can be loaded\n", h[4]);
+				return NULL;
+			}
+
+			pixelWidth = h[6];
+			pixelHeight = h[7] > 0 ? h[7] : 1;
+			rowAlign = 4;	// KTX 1 pads rows to 4 bytes
+			offset = 12 + sizeof(h) + (U64) h[12] + 4;	// skip key/value data and imageSize
+		}
+		else if (type == kKTX2)
+		{
+			// vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth, layerCount, faceCount, levelCount, supercompressionScheme
+			U32 h[9];
+			if (fread(h, sizeof(h), 1, f) != 1)
+			{
+				return NULL;
+			}
+
+			if (h[8] == 0 && (h[0] == kVK_FORMAT_R8G8B8A8_UNORM || h[0] == kVK_FORMAT_R8G8B8A8_SRGB))
+			{
+				components = 4;
+			}
+			else if (h[8] == 0 && (h[0] == kVK_FORMAT_R8G8B8_UNORM || h[0] == kVK_FORMAT_R8G8B8_SRGB))
+			{
+				components = 3;
+			}
+			else
+			{
+				Rtt_LogException("KTX2: vkFormat %u / supercompression %u is not supported, only uncompressed RGBA8/RGB8 textures can be loaded\n", h[0], h[8]);
+				return NULL;
+			}
+
+			pixelWidth = h[2];
+			pixelHeight = h[3] > 0 ? h[3] : 1;
+
+			// level index follows the DFD/KVD/SGD index (4 x U32 + 2 x U64), level 0 is the first entry
+			U64 level0[3];
+			fseek(f, 12 + sizeof(h) + 32, SEEK_SET);
+			if (fread(level0, sizeof(level0), 1, f) != 1)
+			{
+				return NULL;
+			}
+			offset = level0[0];
+		}
+		else
+		{
+			return NULL;
+		}
+
+		// the header comes from the file, nothing is allocated before the size is known to be sane
+		int maxSize = GetMaxSize(true);
+		maxSize = (maxSize > 0) ? maxSize : kKTXMaxSize;
+		if (pixelWidth == 0 || pixelHeight == 0 || pixelWidth > (U32) maxSize || pixelHeight > (U32) maxSize || (size_t) pixelWidth > SIZE_MAX / 4 / pixelHeight)
+		{
+			Rtt_LogException("KTX: invalid size %ux%u\n", pixelWidth, pixelHeight);
+			return NULL;
+		}
+		width = (int) pixelWidth;
+		height = (int) pixelHeight;
+
+		// level 0 must be complete, padding of the last row may be missing
+		size_t rowSize = (size_t) width * components;
+		size_t pitch = (rowSize + rowAlign - 1) & ~(rowAlign - 1);
+		U64 levelSize = (U64) pitch * (height - 1) + rowSize;
+		long fileSize = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+		if (fileSize < 0 || offset > (U64) fileSize || levelSize > (U64) fileSize - offset)
+		{
+			Rtt_LogException("KTX: truncated file\n");
+			return NULL;
+		}
+
+		U8* pixels = (U8*) malloc((size_t) width * height * 4);
+		U8* row = (U8*) malloc(pitch);
+
+		bool ok = pixels && row && fseek(f, (long) offset, SEEK_SET) == 0;
+		U8* dst = pixels;
+		for (int y = 0; ok && y < height; y++)
+		{
+			size_t size = (y < height - 1) ? pitch : rowSize;
+			ok = fread(row, 1, size, f) == size;
+			if (!ok)
+			{
+				break;
+			}
+			if (components == 4)
+			{
+				memcpy(dst, row, rowSize);
+			}
+			else
+			{
+				EmscriptenPixels::ExpandRGBToRGBA(dst, row, width);
+			}
+			dst += (size_t) width * 4;
+		}
+
+		free(row);
+		if (!ok)
+		{
+			Rtt_LogException("KTX: failed to read %dx%d pixels\n", width, height);
+			free(pixels);
+			pixels = NULL;
+		}
+		return pixels;
+	}
+
+}
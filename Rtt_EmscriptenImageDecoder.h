@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include <stdio.h>
+
+namespace Rtt
+{
+
+	// Image decoders which write straight into the RGBA layout the renderer uploads.
+	// Returned buffers are malloc'ed, NULL on failure.
+	class EmscriptenImageDecoder
+	{
+	public:
+		enum ImageType
+		{
+			kUnknown = 0,
+			kPNG,
+			kJPEG,
+			kBMP,
+			kWebP,
+			kKTX,
+			kKTX2,
+		};
+
+		// Detects the format by the magic bytes, the file position is restored
+		static ImageType Sniff(FILE* f);
+
+		// Decodes any supported format to premultiplied RGBA, safe to call from worker threads.
+		// Images larger than maxSize (0 for no limit) are reduced by an integer factor while decoding,
+		// scale receives decoded / original size. premultiply false keeps straight alpha, for pixels written to files.
+		static U8* DecodeFile(const char* path, int& width, int& height, float& scale, int maxSize, bool premultiply = true);
+
+		// Size limits for DecodeFile(): the GL texture size limit always applies,
+		// the soft limit (0 for none) unless the image is requested at full resolution
+		static void SetMaxSize(int hardLimit, int softLimit);
+		static int GetMaxSize(bool isFullResolution);
+
+		// Box filters premultiplied RGBA down to fit maxSize, pixels is freed when reduced.
+		// scale receives the reduction, 1 when the image fits.
+		static U8* Downscale(U8* pixels, int& width, int& height, float& scale, int maxSize);
+
+		// scaleDenom is 1, 2, 4 or 8, the DCT is scaled so a reduced image costs a fraction of a full decode
+		static U8* DecodeJPEG(FILE* f, int& width, int& height, int scaleDenom = 1);
+
+		// Non-interlaced images are box filtered by factor row by row, the full size image is never allocated.
+		// Output is premultiplied unless premultiply is false.
+		static U8* DecodePNG(FILE* f, int& width, int& height, int factor = 1, bool premultiply = true);
+
+		// Needs libwebp, enabled with Rtt_EMSCRIPTEN_WEBP
+		static U8* DecodeWebP(FILE* f, int& width, int& height);
+
+		// Base level of an uncompressed RGBA8/RGB8 KTX or KTX2 container.
+		// Compressed payloads (ETC2/ASTC/S3TC/Basis) fail, the renderer takes only RGBA/RGB/mask bitmaps.
+		static U8* DecodeKTX(FILE* f, int& width, int& height);
+	};
+
+}
@@ -0,0 +1,295 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Core/Rtt_String.h"
+#include "Rtt_EmscriptenImageEncoder.h"
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "png.h"
+
+extern "C"
+{
+#include "jpeglib.h"
+#include "jerror.h"
+}
+
+#if defined(Rtt_EMSCRIPTEN_WEBP)
+#include "webp/encode.h"
+#endif
+
+namespace Rtt
+{
+
+	// zlib level 3 is several times faster than the default 6 on screenshots for a few percent in size
+	static int sPNGCompression = 3;
+	static int sPNGFilters = EmscriptenImageEncoder::kFilterSub;
+
+	void EmscriptenImageEncoder::SetPNGOptions(int compressionLevel, int filters)
+	{
+		sPNGCompression = compressionLevel < 0 ? 0 : (compressionLevel > 9 ? 9 : compressionLevel);
+		sPNGFilters = (filters & kFilterAll) ? (filters & kFilterAll) : kFilterSub;
+	}
+
+	int EmscriptenImageEncoder::GetPNGCompression()
+	{
+		return sPNGCompression;
+	}
+
+	int EmscriptenImageEncoder::GetPNGFilters()
+	{
+		return sPNGFilters;
+	}
+
+	EmscriptenImageEncoder::ImageType EmscriptenImageEncoder::GetType(const char* path)
+	{
+		const char* ext = path ? strrchr(path, '.') : NULL;
+		if (ext == NULL)
+		{
+			return kUnknown;
+		}
+		if (Rtt_StringCompareNoCase(ext, ".png") == 0)
+		{
+			return kPNG;
+		}
+		if (Rtt_StringCompareNoCase(ext, ".jpg") == 0 || Rtt_StringCompareNoCase(ext, ".jpeg") == 0)
+		{
+			return kJPEG;
+		}
+		if (Rtt_StringCompareNoCase(ext, ".webp") == 0)
+		{
+			return kWebP;
+		}
+		return kUnknown;
+	}
+
+	static int BytesPerPixel(PlatformBitmap::Format format)
+	{
+		switch (format)
+		{
+			case PlatformBitmap::kMask:
+				return 1;
+			case PlatformBitmap::kRGB:
+				return 3;
+			default:
+				return 4;
+		}
+	}
+
+	bool EmscriptenImageEncoder::Save(const char* path, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality)
+	{
+		ImageType type = GetType(path);
+		if (type == kUnknown)
+		{
+			Rtt_LogException("Failed to save %s, HTML5 supports .png, .jpg and .webp files\n", path);
+			return false;
+		}
+
+		FILE* f = fopen(path, "wb");
+		if (f == NULL)
+		{
+			Rtt_LogException("Failed to save %s, the file can not be created\n", path);
+			return false;
+		}
+
+		bool result = false;
+		switch (type)
+		{
+			case kPNG:
+				result = EncodePNG(f, bits, width, height, format);
+				break;
+			case kJPEG:
+				result = EncodeJPEG(f, bits, width, height, format, quality);
+				break;
+			case kWebP:
+				result = EncodeWebP(f, bits, width, height, format, quality);
+				break;
+			default:
+				break;
+		}
+
+		fclose(f);
+		if (!result)
+		{
+			remove(path);
+		}
+		return result;
+	}
+
+	bool EmscriptenImageEncoder::EncodePNG(FILE* f, const U8* bits, int width, int height, PlatformBitmap::Format format)
+	{
+		png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+		png_infop info = png ? png_create_info_struct(png) : NULL;
+		if (info == NULL)
+		{
+			png_destroy_write_struct(&png, NULL);
+			return false;
+		}
+
+		if (setjmp(png_jmpbuf(png)))
+		{
+			png_destroy_write_struct(&png, &info);
+			return false;
+		}
+
+		int colorType = PNG_COLOR_TYPE_RGB_ALPHA;
+		if (format == PlatformBitmap::kMask)
+		{
+			colorType = PNG_COLOR_TYPE_GRAY;
+		}
+		else if (format == PlatformBitmap::kRGB)
+		{
+			colorType = PNG_COLOR_TYPE_RGB;
+		}
+
+		png_init_io(png, f);
+		png_set_IHDR(png, info, width, height, 8, colorType, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		png_set_compression_level(png, sPNGCompression);
+		png_set_filter(png, PNG_FILTER_TYPE_BASE, sPNGFilters);
+		png_write_info(png, info);
+		if (format == PlatformBitmap::kBGRA)
+		{
+			png_set_bgr(png);
+		}
+
+		// rows go straight from the bitmap, no conversion buffer
+		size_t pitch = width * BytesPerPixel(format);
+		for (int y = 0; y < height; y++)
+		{
+			png_write_row(png, (png_bytep) (bits + y * pitch));
+		}
+
+		png_write_end(png, NULL);
+		png_destroy_write_struct(&png, &info);
+		return true;
+	}
+
+	// libjpeg calls exit() on errors by default, jump back to the encoder instead
+	struct JPEGEncodeErrorManager
+	{
+		jpeg_error_mgr pub;
+		jmp_buf jump;
+	};
+
+	static void JPEGEncodeErrorExit(j_common_ptr cinfo)
+	{
+		char msg[JMSG_LENGTH_MAX];
+		(*cinfo->err->format_message)(cinfo, msg);
+		Rtt_LogException("JPEG encode failed: %s\n", msg);
+
+		JPEGEncodeErrorManager* err = (JPEGEncodeErrorManager*) cinfo->err;
+		longjmp(err->jump, 1);
+	}
+
+	bool EmscriptenImageEncoder::EncodeJPEG(FILE* f, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality)
+	{
+		jpeg_compress_struct cinfo;
+		JPEGEncodeErrorManager jerr;
+
+		// volatile, it is read after longjmp
+		U8* volatile row = NULL;
+
+		cinfo.err = jpeg_std_error(&jerr.pub);
+		jerr.pub.error_exit = JPEGEncodeErrorExit;
+		if (setjmp(jerr.jump))
+		{
+			jpeg_destroy_compress(&cinfo);
+			free(row);
+			return false;
+		}
+
+		jpeg_create_compress(&cinfo);
+		jpeg_stdio_dest(&cinfo, f);
+
+		bool isGray = (format == PlatformBitmap::kMask);
+		cinfo.image_width = width;
+		cinfo.image_height = height;
+		cinfo.input_components = isGray ? 1 : 3;
+		cinfo.in_color_space = isGray ? JCS_GRAYSCALE : JCS_RGB;
+		jpeg_set_defaults(&cinfo);
+
+		int q = (int) (quality * 100.0f + 0.5f);
+		jpeg_set_quality(&cinfo, q < 1 ? 1 : (q > 100 ? 100 : q), TRUE);
+		jpeg_start_compress(&cinfo, TRUE);
+
+		// RGBA/BGRA rows are converted to RGB, alpha is dropped
+		int bpp = BytesPerPixel(format);
+		bool isDirect = isGray || format == PlatformBitmap::kRGB;
+		if (!isDirect)
+		{
+			row = (U8*) malloc(width * 3);
+			if (row == NULL)
+			{
+				ERREXIT(&cinfo, JERR_OUT_OF_MEMORY);
+			}
+		}
+
+		int r = (format == PlatformBitmap::kBGRA) ? 2 : 0;
+		int b = 2 - r;
+		while (cinfo.next_scanline < cinfo.image_height)
+		{
+			const U8* src = bits + cinfo.next_scanline * width * bpp;
+			JSAMPROW line = (JSAMPROW) src;
+			if (!isDirect)
+			{
+				U8* dst = row;
+				for (int x = 0; x < width; x++, src += 4, dst += 3)
+				{
+					dst[0] = src[r];
+					dst[1] = src[1];
+					dst[2] = src[b];
+				}
+				line = row;
+			}
+			jpeg_write_scanlines(&cinfo, &line, 1);
+		}
+
+		jpeg_finish_compress(&cinfo);
+		jpeg_destroy_compress(&cinfo);
+		free(row);
+		return true;
+	}
+
+	bool EmscriptenImageEncoder::EncodeWebP(FILE* f, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality)
+	{
+#if defined(Rtt_EMSCRIPTEN_WEBP)
+		if (format == PlatformBitmap::kMask)
+		{
+			Rtt_LogException("WebP encoding of masks is not supported\n");
+			return false;
+		}
+
+		U8* output = NULL;
+		size_t size = 0;
+		float q = quality * 100.0f;
+		int stride = width * BytesPerPixel(format);
+		switch (format)
+		{
+			case PlatformBitmap::kRGB:
+				size = WebPEncodeRGB(bits, width, height, stride, q, &output);
+				break;
+			case PlatformBitmap::kBGRA:
+				size = WebPEncodeBGRA(bits, width, height, stride, q, &output);
+				break;
+			default:
+				size = WebPEncodeRGBA(bits, width, height, stride, q, &output);
+				break;
+		}
+
+		bool result = size > 0 && fwrite(output, 1, size, f) == size;
+		WebPFree(output);
+		return result;
+#else
+		Rtt_LogException("WebP images are not supported by this build\n");
+		return false;
+#endif
+	}
+
+}
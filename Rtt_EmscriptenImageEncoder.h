@@ -0,0 +1,61 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include "Display/Rtt_PlatformBitmap.h"
+#include <stdio.h>
+
+namespace Rtt
+{
+
+	// Image encoders for display.save() and display.captureScreen(), picked by the file extension.
+	// Safe to call from worker threads.
+	class EmscriptenImageEncoder
+	{
+	public:
+		enum ImageType
+		{
+			kUnknown = 0,
+			kPNG,
+			kJPEG,
+			kWebP,
+		};
+
+		// PNG filter selection, the values are libpng's PNG_FILTER_* masks
+		enum PNGFilter
+		{
+			kFilterNone = 0x08,
+			kFilterSub = 0x10,
+			kFilterUp = 0x20,
+			kFilterAverage = 0x40,
+			kFilterPaeth = 0x80,
+			kFilterAll = 0xF8,		// libpng picks per row, smallest files, slowest
+		};
+
+		static ImageType GetType(const char* path);
+
+		// Writes width x height pixels of the given format (mask, RGB, RGBA or BGRA).
+		// quality is 0..1, used by JPEG and WebP.
+		static bool Save(const char* path, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality);
+
+		// zlib level 0..9 and PNGFilter mask, the defaults favour speed over size
+		static void SetPNGOptions(int compressionLevel, int filters);
+		static int GetPNGCompression();
+		static int GetPNGFilters();
+
+		static bool EncodePNG(FILE* f, const U8* bits, int width, int height, PlatformBitmap::Format format);
+		static bool EncodeJPEG(FILE* f, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality);
+
+		// Needs libwebp, enabled with Rtt_EMSCRIPTEN_WEBP
+		static bool EncodeWebP(FILE* f, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality);
+	};
+
+}
@@ -128,7 +128,9 @@ namespace Rtt
 			lua_setfield(L, -2, "completed");
 
 			Runtime* runtime = LuaContext::GetRuntime(L);
-			EmscriptenBaseBitmap* bitmap = new EmscriptenBaseBitmap(runtime->GetAllocator(), fWidth, fHeight, fData);
+			// the bitmap adopts the frame JS has written into the heap, no copy
+			EmscriptenBaseBitmap* bitmap = new EmscriptenBaseBitmap(fWidth, fHeight, fData);
+			fData = NULL;
 			BitmapPaint* paint = BitmapPaint::NewBitmap(runtime->GetDisplay().GetTextureFactory(), bitmap, false);
 			LuaLibDisplay::PushImage(L, NULL, paint, runtime->GetDisplay(), NULL);
 			lua_setfield(L, -2, "target");
@@ -55,18 +55,24 @@ namespace Rtt
 				, fData(0)
 			{}
 
+			// buf is malloc'ed by JS, owned by the event until a bitmap adopts it
 			EmscriptenImageProviderCompletionEvent(int w, int h, uint8_t* buf)
 				: fWidth(w)
 				, fHeight(h)
 				, fData(buf)
 			{}
 
+			~EmscriptenImageProviderCompletionEvent()
+			{
+				free(fData);
+			}
+
 			virtual int Push( lua_State *L ) const override;
 
 		private:
 			int fWidth;
 			int fHeight;
-			uint8_t* fData;
+			mutable uint8_t* fData;
 		};
 
 		EmscriptenImageProvider(const ResourceHandle<lua_State> & handle, int w, int h);
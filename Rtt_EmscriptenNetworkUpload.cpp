@@ -0,0 +1,42 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenNetworkUpload.h"
+
+#if defined(EMSCRIPTEN)
+#include "emscripten/emscripten.h"
+
+extern "C"
+{
+	// JS ==> C callback, once per chunk
+	void EMSCRIPTEN_KEEPALIVE jsNetworkUploadProgress(Rtt::EmscriptenNetworkUpload::ProgressCallback progress, void* requestPtr, double sent, double total)
+	{
+		if (progress)
+		{
+			progress(requestPtr, sent, total);
+		}
+	}
+
+	extern int jsNetworkRequestFile(const char* url, const char* method, const char* headers, const char* path, void* requestPtr, void* progress);
+}
+#else
+	int jsNetworkRequestFile(const char* url, const char* method, const char* headers, const char* path, void* requestPtr, void* progress) { return 0; }
+#endif
+
+namespace Rtt
+{
+
+	bool EmscriptenNetworkUpload::Send(const char* url, const char* method, const char* headers, const char* path,
+		void* requestPtr, ProgressCallback progress)
+	{
+		return jsNetworkRequestFile(url, method, headers ? headers : "", path, requestPtr, (void*) progress) != 0;
+	}
+
+}
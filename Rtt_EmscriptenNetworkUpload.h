@@ -0,0 +1,34 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace Rtt
+{
+
+	// Streamed request bodies for the network plugin.
+	// network.upload() and network.request() with body = { filename = ... } call Send() with the resolved path
+	// instead of reading the file into a Lua string and passing it to jsNetworkRequest.
+	// The file is read in chunks of Module.networkUploadChunkSize bytes (1MB by default), so memory used by the upload
+	// stays bounded by the chunk size where the browser supports streamed fetch bodies.
+	// Other browsers get an XMLHttpRequest with a view on the file, without a copy in the heap.
+	// The response is passed to jsNetworkDispatch(requestPtr, ...) as it is for jsNetworkRequest.
+	class EmscriptenNetworkUpload
+	{
+		public:
+			// Called for every chunk handed to the browser, sent and total are in bytes
+			typedef void (*ProgressCallback)(void* requestPtr, double sent, double total);
+
+			// headers are "key: value|key: value" like those of jsNetworkRequest, progress may be NULL.
+			// Returns false if path can not be read, nothing is sent then.
+			static bool Send(const char* url, const char* method, const char* headers, const char* path,
+				void* requestPtr, ProgressCallback progress);
+	};
+
+}
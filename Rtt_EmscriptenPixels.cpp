@@ -0,0 +1,288 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenPixels.h"
+#include <string.h>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define Rtt_PIXELS_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#endif
+
+namespace Rtt
+{
+
+	// x / 255 rounded, exact for x <= 255 * 255
+	static inline U8 Div255(U32 x)
+	{
+		x += 128;
+		return (U8)((x + (x >> 8)) >> 8);
+	}
+
+	void EmscriptenPixels::Premultiply(U8* dst, const U8* src, size_t count)
+	{
+		size_t i = 0;
+
+#if defined(__wasm_simd128__)
+		// 4 pixels per iteration, two pixels per 16 bit half, alpha multiplier is 255 so alpha passes through
+		const v128_t k255 = wasm_i16x8_splat(255);
+		const v128_t k128 = wasm_i16x8_splat(128);
+		for (; i + 4 <= count; i += 4)
+		{
+			v128_t v = wasm_v128_load(src + i * 4);
+			v128_t lo = wasm_u16x8_extend_low_u8x16(v);
+			v128_t hi = wasm_u16x8_extend_high_u8x16(v);
+			v128_t alo = wasm_i8x16_shuffle(lo, k255, 6, 7, 6, 7, 6, 7, 16, 17, 14, 15, 14, 15, 14, 15, 16, 17);
+			v128_t ahi = wasm_i8x16_shuffle(hi, k255, 6, 7, 6, 7, 6, 7, 16, 17, 14, 15, 14, 15, 14, 15, 16, 17);
+			lo = wasm_i16x8_add(wasm_i16x8_mul(lo, alo), k128);
+			hi = wasm_i16x8_add(wasm_i16x8_mul(hi, ahi), k128);
+			lo = wasm_u16x8_shr(wasm_i16x8_add(lo, wasm_u16x8_shr(lo, 8)), 8);
+			hi = wasm_u16x8_shr(wasm_i16x8_add(hi, wasm_u16x8_shr(hi, 8)), 8);
+			wasm_v128_store(dst + i * 4, wasm_u8x16_narrow_i16x8(lo, hi));
+		}
+#elif defined(Rtt_PIXELS_SSE2)
+		const __m128i kZero = _mm_setzero_si128();
+		const __m128i kRGBMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+		const __m128i kAlpha255 = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		const __m128i k128 = _mm_set1_epi16(128);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(src + i * 4));
+			__m128i lo = _mm_unpacklo_epi8(v, kZero);
+			__m128i hi = _mm_unpackhi_epi8(v, kZero);
+			__m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+			__m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+			alo = _mm_or_si128(_mm_and_si128(alo, kRGBMask), kAlpha255);
+			ahi = _mm_or_si128(_mm_and_si128(ahi, kRGBMask), kAlpha255);
+			lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), k128);
+			hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), k128);
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+			_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_packus_epi16(lo, hi));
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			const U8* s = src + i * 4;
+			U8* d = dst + i * 4;
+			U8 a = s[3];
+			d[0] = Div255(s[0] * a);
+			d[1] = Div255(s[1] * a);
+			d[2] = Div255(s[2] * a);
+			d[3] = a;
+		}
+	}
+
+	// Division by alpha is a per-pixel divisor, which SIMD can not do better than a reciprocal table
+	void EmscriptenPixels::Unpremultiply(U8* dst, const U8* src, size_t count)
+	{
+		static U32 sReciprocal[256];		// (255 << 16) / a rounded
+		if (sReciprocal[1] == 0)
+		{
+			for (U32 a = 1; a < 256; a++)
+			{
+				sReciprocal[a] = ((255u << 16) + a / 2) / a;
+			}
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const U8* s = src + i * 4;
+			U8* d = dst + i * 4;
+			U32 a = s[3];
+			if (a == 255)
+			{
+				if (d != s)
+				{
+					memcpy(d, s, 4);
+				}
+				continue;
+			}
+
+			U32 r = sReciprocal[a];
+			for (int k = 0; k < 3; k++)
+			{
+				U32 c = (s[k] * r + 32768) >> 16;
+				d[k] = (U8)(c > 255 ? 255 : c);
+			}
+			d[3] = (U8)a;
+		}
+	}
+
+	void EmscriptenPixels::ExpandRGBToRGBA(U8* dst, const U8* src, size_t count)
+	{
+		size_t i = 0;
+
+		// 16 byte loads read 4 bytes past the 4 pixels, so stop 2 pixels early
+#if defined(__wasm_simd128__)
+		const v128_t kAlpha = wasm_i32x4_splat((int)0xFF000000);
+		for (; i + 6 <= count; i += 4)
+		{
+			v128_t v = wasm_v128_load(src + i * 3);
+			v = wasm_i8x16_shuffle(v, v, 0, 1, 2, 0, 3, 4, 5, 0, 6, 7, 8, 0, 9, 10, 11, 0);
+			wasm_v128_store(dst + i * 4, wasm_v128_or(v, kAlpha));
+		}
+#elif defined(Rtt_PIXELS_SSE2) && defined(__SSSE3__)
+		const __m128i kAlpha = _mm_set1_epi32((int)0xFF000000);
+		const __m128i kShuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		for (; i + 6 <= count; i += 4)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+			_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, kShuffle), kAlpha));
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			const U8* s = src + i * 3;
+			U8* d = dst + i * 4;
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+			d[3] = 255;
+		}
+	}
+
+	void EmscriptenPixels::Luminance(U8* dst, const U8* src, size_t count, int bpp)
+	{
+		size_t i = 0;
+
+		if (bpp == 4)
+		{
+#if defined(__wasm_simd128__)
+			// dot product gives (77 R + 151 G) and (28 B) per pixel, the pairs are summed in 64 bit lanes
+			const v128_t kWeights = wasm_i16x8_const(77, 151, 28, 0, 77, 151, 28, 0);
+			for (; i + 4 <= count; i += 4)
+			{
+				v128_t v = wasm_v128_load(src + i * 4);
+				v128_t lo = wasm_i32x4_dot_i16x8(wasm_u16x8_extend_low_u8x16(v), kWeights);
+				v128_t hi = wasm_i32x4_dot_i16x8(wasm_u16x8_extend_high_u8x16(v), kWeights);
+				lo = wasm_i32x4_add(lo, wasm_u64x2_shr(lo, 32));
+				hi = wasm_i32x4_add(hi, wasm_u64x2_shr(hi, 32));
+				v128_t y = wasm_u32x4_shr(wasm_i32x4_shuffle(lo, hi, 0, 2, 4, 6), 8);
+				y = wasm_u16x8_narrow_i32x4(y, y);
+				y = wasm_u8x16_narrow_i16x8(y, y);
+				U32 out = wasm_i32x4_extract_lane(y, 0);
+				memcpy(dst + i, &out, 4);
+			}
+#elif defined(Rtt_PIXELS_SSE2)
+			const __m128i kZero = _mm_setzero_si128();
+			const __m128i kWeights = _mm_set_epi16(0, 28, 151, 77, 0, 28, 151, 77);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)(src + i * 4));
+				__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, kZero), kWeights);
+				__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, kZero), kWeights);
+				lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+				hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+				__m128i y = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+				y = _mm_srli_epi32(y, 8);
+				y = _mm_packs_epi32(y, y);
+				y = _mm_packus_epi16(y, y);
+				U32 out = (U32)_mm_cvtsi128_si32(y);
+				memcpy(dst + i, &out, 4);
+			}
+#endif
+		}
+
+		for (; i < count; i++)
+		{
+			const U8* s = src + i * bpp;
+			dst[i] = (U8)((77 * s[0] + 151 * s[1] + 28 * s[2]) >> 8);
+		}
+	}
+
+	void EmscriptenPixels::ExtractChannel(U8* dst, const U8* src, size_t count, int channel)
+	{
+		size_t i = 0;
+		int shift = channel * 8;
+
+		// 16 pixels per step, the channel is shifted to the low byte and the lanes narrowed twice
+#if defined(__wasm_simd128__)
+		const v128_t kMask = wasm_i32x4_splat(0xFF);
+		for (; i + 16 <= count; i += 16)
+		{
+			const U8* s = src + i * 4;
+			v128_t a = wasm_v128_and(wasm_u32x4_shr(wasm_v128_load(s), shift), kMask);
+			v128_t b = wasm_v128_and(wasm_u32x4_shr(wasm_v128_load(s + 16), shift), kMask);
+			v128_t c = wasm_v128_and(wasm_u32x4_shr(wasm_v128_load(s + 32), shift), kMask);
+			v128_t d = wasm_v128_and(wasm_u32x4_shr(wasm_v128_load(s + 48), shift), kMask);
+			v128_t ab = wasm_u16x8_narrow_i32x4(a, b);
+			v128_t cd = wasm_u16x8_narrow_i32x4(c, d);
+			wasm_v128_store(dst + i, wasm_u8x16_narrow_i16x8(ab, cd));
+		}
+#elif defined(Rtt_PIXELS_SSE2)
+		const __m128i kMask = _mm_set1_epi32(0xFF);
+		const __m128i kShift = _mm_cvtsi32_si128(shift);
+		for (; i + 16 <= count; i += 16)
+		{
+			const U8* s = src + i * 4;
+			__m128i a = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)s), kShift), kMask);
+			__m128i b = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(s + 16)), kShift), kMask);
+			__m128i c = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(s + 32)), kShift), kMask);
+			__m128i d = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(s + 48)), kShift), kMask);
+			__m128i ab = _mm_packs_epi32(a, b);
+			__m128i cd = _mm_packs_epi32(c, d);
+			_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(ab, cd));
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			dst[i] = src[i * 4 + channel];
+		}
+	}
+
+	bool EmscriptenPixels::IsOpaque(const U8* src, size_t count)
+	{
+		size_t i = 0;
+		U32 alpha = 0xFF;
+
+#if defined(__wasm_simd128__)
+		// and all pixels together, then only the alpha bytes have to be all ones
+		const v128_t kOnes = wasm_i32x4_splat(-1);
+		v128_t acc = kOnes;
+		for (; i + 4 <= count; i += 4)
+		{
+			acc = wasm_v128_and(acc, wasm_v128_load(src + i * 4));
+		}
+		acc = wasm_v128_or(acc, wasm_i32x4_splat(0x00FFFFFF));
+		if (!wasm_i32x4_all_true(wasm_i32x4_eq(acc, kOnes)))
+		{
+			return false;
+		}
+#elif defined(Rtt_PIXELS_SSE2)
+		const __m128i kOnes = _mm_set1_epi32(-1);
+		__m128i acc = kOnes;
+		for (; i + 4 <= count; i += 4)
+		{
+			acc = _mm_and_si128(acc, _mm_loadu_si128((const __m128i*)(src + i * 4)));
+		}
+		acc = _mm_or_si128(acc, _mm_set1_epi32(0x00FFFFFF));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(acc, kOnes)) != 0xFFFF)
+		{
+			return false;
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			alpha &= src[i * 4 + 3];
+		}
+		return alpha == 0xFF;
+	}
+
+}
@@ -0,0 +1,43 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include <stddef.h>
+
+namespace Rtt
+{
+
+	// Pixel conversion kernels used by bitmap loading.
+	// wasm SIMD when built with -msimd128, SSE2/SSSE3 on native builds, scalar otherwise.
+	// All functions take a pixel count, src and dst may be the same buffer where noted.
+	class EmscriptenPixels
+	{
+	public:
+		// c = c * a / 255 rounded, alpha is kept; dst may be src
+		static void Premultiply(U8* dst, const U8* src, size_t count);
+
+		// c = c * 255 / a rounded, 0 if a == 0; dst may be src
+		static void Unpremultiply(U8* dst, const U8* src, size_t count);
+
+		// RGB ==> RGBA with opaque alpha; dst must not overlap src
+		static void ExpandRGBToRGBA(U8* dst, const U8* src, size_t count);
+
+		// (77 R + 151 G + 28 B) >> 8, bpp is 3 or 4; dst may be src
+		static void Luminance(U8* dst, const U8* src, size_t count, int bpp);
+
+		// one byte of each RGBA pixel, channel 0..3; dst may be src
+		static void ExtractChannel(U8* dst, const U8* src, size_t count, int channel);
+
+		// true if every RGBA pixel has alpha 255, premultiplying such an image changes nothing
+		static bool IsOpaque(const U8* src, size_t count);
+	};
+
+}
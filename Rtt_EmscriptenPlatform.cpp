@@ -15,14 +15,24 @@
 #include "Rtt_EmscriptenPlatform.h"
 #include "Rtt_EmscriptenAudioPlayer.h"
 #include "Rtt_EmscriptenAudioRecorder.h"
+#include "Rtt_EmscriptenAtlas.h"
 #include "Rtt_EmscriptenBitmap.h"
+#include "Rtt_EmscriptenBitmapCache.h"
 #include "Rtt_EmscriptenEventSound.h"
 #include "Rtt_EmscriptenFBConnect.h"
 #include "Rtt_EmscriptenFont.h"
+#include "Rtt_EmscriptenGlyphAtlas.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenImageEncoder.h"
 #include "Rtt_EmscriptenImageProvider.h"
 #include "Rtt_EmscriptenMapViewObject.h"
+#include "Rtt_EmscriptenReachability.h"
+#include "Rtt_EmscriptenSaveQueue.h"
 #include "Rtt_EmscriptenScreenSurface.h"
+#include "Rtt_EmscriptenSocket.h"
 #include "Rtt_EmscriptenStoreProvider.h"
+#include "Rtt_EmscriptenTextCache.h"
+#include "Rtt_EmscriptenTextMetrics.h"
 #include "Rtt_EmscriptenTextBoxObject.h"
 #include "Rtt_EmscriptenVideoObject.h"
 #include "Rtt_EmscriptenVideoPlayer.h"
@@ -30,6 +40,7 @@
 #include "Rtt_EmscriptenWebPopup.h"
 #include "Rtt_EmscriptenWebViewObject.h"
 #include "Rtt_EmscriptenContainer.h"
+#include "Rtt_EmscriptenDecodeQueue.h"
 #include "Rtt_PreferenceCollection.h"
 
 #if defined(EMSCRIPTEN)
@@ -97,7 +108,14 @@ extern "C"
 #if !defined( Rtt_CUSTOM_CODE )
 Rtt_EXPORT const luaL_Reg* Rtt_GetCustomModulesList()
 {
-	return NULL;
+	static const luaL_Reg kModules[] =
+	{
+		{ "socket.websocket", Rtt::EmscriptenSocket::Open },
+		{ "imageAtlas", Rtt::EmscriptenAtlas::Open },
+		{ "textMetrics", Rtt::EmscriptenTextMetrics::Open },
+		{ NULL, NULL }
+	};
+	return kModules;
 }
 #endif
 
@@ -461,7 +479,7 @@ namespace Rtt
 
 	bool EmscriptenPlatform::SaveBitmap(PlatformBitmap * bitmap, const char * filePath, float jpegQuality) const
 	{
-		return EmscriptenBaseBitmap::SaveBitmap(fAllocator, bitmap, filePath);
+		return EmscriptenBaseBitmap::SaveBitmap(fAllocator, bitmap, filePath, jpegQuality);
 	}
 
 	bool EmscriptenPlatform::AddBitmapToPhotoLibrary(PlatformBitmap* bitmap) const
@@ -786,6 +804,190 @@ namespace Rtt
 				CoronaLuaWarning(L, "native.setProperty(\"%s\") was given an invalid value type.", key);
 			}
 		}
+		else if (Rtt_StringCompare(key, "imagePrefetch") == 0)
+		{
+			// { "a.png", "b.jpg", listener = function(event) end } decodes resource images ahead of display.newImage()
+			// false frees prefetched images which were not used
+			if (lua_istable(L, valueIndex))
+			{
+				std::vector<std::string> paths;
+				int n = (int) lua_objlen(L, valueIndex);
+				for (int i = 1; i <= n; i++)
+				{
+					lua_rawgeti(L, valueIndex, i);
+					const char *filename = lua_tostring(L, -1);
+					if (filename)
+					{
+						String path(&GetAllocator());
+						PathForFile(filename, MPlatform::kResourceDir, MPlatform::kDefaultPathFlags, path);
+						if (path.GetString())
+						{
+							paths.push_back(path.GetString());
+						}
+					}
+					lua_pop(L, 1);
+				}
+
+				lua_getfield(L, valueIndex, "listener");
+				EmscriptenDecodeQueue::Instance().Prefetch(L, paths, lua_gettop(L));
+				lua_pop(L, 1);
+			}
+			else if (lua_type(L, valueIndex) == LUA_TBOOLEAN && !lua_toboolean(L, valueIndex))
+			{
+				EmscriptenDecodeQueue::Instance().Clear();
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") was given an invalid value type.", key);
+			}
+		}
+		else if (Rtt_StringCompare(key, "imageDecoder") == 0)
+		{
+			// "browser" decodes prefetched images with createImageBitmap where available, "wasm" with the built-in decoders
+			const char *value = lua_tostring(L, valueIndex);
+			if (value && (Rtt_StringCompare(value, "browser") == 0 || Rtt_StringCompare(value, "wasm") == 0))
+			{
+				EmscriptenDecodeQueue::Instance().SetBrowserDecode(Rtt_StringCompare(value, "browser") == 0);
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") expects \"browser\" or \"wasm\".", key);
+			}
+		}
+		else if (Rtt_StringCompare(key, "bitmapCacheSize") == 0)
+		{
+			// byte budget of decoded images kept for reuse, 0 disables the cache
+			if (lua_type(L, valueIndex) == LUA_TNUMBER && lua_tonumber(L, valueIndex) >= 0)
+			{
+				EmscriptenBitmapCache::Instance().SetBudget((size_t) lua_tonumber(L, valueIndex));
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") was given an invalid value type.", key);
+			}
+		}
+		else if (Rtt_StringCompare(key, "textCacheSize") == 0)
+		{
+			// byte budget of rendered text kept for reuse after its text objects are gone, 0 disables the cache
+			if (lua_type(L, valueIndex) == LUA_TNUMBER && lua_tonumber(L, valueIndex) >= 0)
+			{
+				EmscriptenTextCache::Instance().SetBudget((size_t) lua_tonumber(L, valueIndex));
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") was given an invalid value type.", key);
+			}
+		}
+		else if (Rtt_StringCompare(key, "textRenderer") == 0)
+		{
+			// "native" rasterizes text with the glyph atlas where the font has a file, "canvas" draws it in the browser
+			const char *value = lua_tostring(L, valueIndex);
+			if (value && (Rtt_StringCompare(value, "native") == 0 || Rtt_StringCompare(value, "canvas") == 0))
+			{
+				bool isNative = Rtt_StringCompare(value, "native") == 0;
+				if (isNative && !EmscriptenGlyphAtlas::IsSupported())
+				{
+					CoronaLuaWarning(L, "native.setProperty(\"%s\"): this build has no native text support, using \"canvas\".", key);
+				}
+				EmscriptenGlyphAtlas::Instance().SetEnabled(isNative);
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") expects \"native\" or \"canvas\".", key);
+			}
+		}
+		else if (Rtt_StringCompare(key, "imageSaveOptions") == 0)
+		{
+			// { async = true, listener = function(event) end, pngCompression = 0..9, pngFilter = "sub" }
+			// async encodes on a worker only in -pthread builds, otherwise it defers to a later frame
+			if (lua_istable(L, valueIndex))
+			{
+				EmscriptenSaveQueue& queue = EmscriptenSaveQueue::Instance();
+				lua_getfield(L, valueIndex, "async");
+				if (!lua_isnil(L, -1))
+				{
+					queue.SetAsync(lua_toboolean(L, -1) ? true : false);
+				}
+				lua_pop(L, 1);
+
+				lua_getfield(L, valueIndex, "listener");
+				if (!lua_isnil(L, -1))
+				{
+					queue.SetListener(L, lua_gettop(L));
+				}
+				lua_pop(L, 1);
+
+				int compression = EmscriptenImageEncoder::GetPNGCompression();
+				lua_getfield(L, valueIndex, "pngCompression");
+				if (lua_type(L, -1) == LUA_TNUMBER)
+				{
+					compression = (int) lua_tointeger(L, -1);
+				}
+				lua_pop(L, 1);
+
+				int filters = EmscriptenImageEncoder::GetPNGFilters();
+				lua_getfield(L, valueIndex, "pngFilter");
+				const char *filter = lua_tostring(L, -1);
+				if (filter)
+				{
+					static const struct { const char* name; int mask; } kFilters[] =
+					{
+						{ "none", EmscriptenImageEncoder::kFilterNone },
+						{ "sub", EmscriptenImageEncoder::kFilterSub },
+						{ "up", EmscriptenImageEncoder::kFilterUp },
+						{ "average", EmscriptenImageEncoder::kFilterAverage },
+						{ "paeth", EmscriptenImageEncoder::kFilterPaeth },
+						{ "all", EmscriptenImageEncoder::kFilterAll },
+					};
+					filters = 0;
+					for (size_t i = 0; i < sizeof(kFilters) / sizeof(kFilters[0]); i++)
+					{
+						if (Rtt_StringCompare(filter, kFilters[i].name) == 0)
+						{
+							filters = kFilters[i].mask;
+						}
+					}
+					if (filters == 0)
+					{
+						CoronaLuaWarning(L, "native.setProperty(\"%s\") unknown pngFilter \"%s\".", key, filter);
+						filters = EmscriptenImageEncoder::GetPNGFilters();
+					}
+				}
+				lua_pop(L, 1);
+
+				EmscriptenImageEncoder::SetPNGOptions(compression, filters);
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") was given an invalid value type.", key);
+			}
+		}
+		else if (Rtt_StringCompare(key, "imageMaxSize") == 0)
+		{
+			// larger images are reduced while loading unless display.newImage() asks for full resolution,
+			// "screen" is the drawable size of the canvas, 0 loads images at their own size
+			int hardLimit = EmscriptenImageDecoder::GetMaxSize(true);
+			if (lua_type(L, valueIndex) == LUA_TNUMBER && lua_tonumber(L, valueIndex) >= 0)
+			{
+				EmscriptenImageDecoder::SetMaxSize(hardLimit, (int) lua_tonumber(L, valueIndex));
+				EmscriptenBitmapCache::Instance().Clear();
+			}
+			else if (lua_type(L, valueIndex) == LUA_TSTRING && Rtt_StringCompare(lua_tostring(L, valueIndex), "screen") == 0)
+			{
+				int w = 0, h = 0;
+				SDL_Window* window = SDL_GL_GetCurrentWindow();
+				if (window)
+				{
+					SDL_GL_GetDrawableSize(window, &w, &h);
+				}
+				EmscriptenImageDecoder::SetMaxSize(hardLimit, w > h ? w : h);
+				EmscriptenBitmapCache::Instance().Clear();
+			}
+			else
+			{
+				CoronaLuaWarning(L, "native.setProperty(\"%s\") expects a size or \"screen\".", key);
+			}
+		}
 		else
 		{
 			CoronaLuaWarning(L, "native.setProperty(\"%s\") is not supported on HTML5", key);
@@ -808,6 +1010,117 @@ namespace Rtt
 			lua_pushboolean(L, val == SDL_ENABLE ? true : false);
 			pushedValues = 1;
 		}
+		else if (Rtt_StringCompare(key, "imageDecoder") == 0)
+		{
+			lua_pushstring(L, EmscriptenDecodeQueue::Instance().IsBrowserDecode() ? "browser" : "wasm");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "imageDecoderStats") == 0)
+		{
+			// number of images decoded by each path
+			EmscriptenDecodeQueue::Stats stats = EmscriptenDecodeQueue::Instance().GetStats();
+			lua_createtable(L, 0, 4);
+			lua_pushinteger(L, stats.fBrowser);
+			lua_setfield(L, -2, "browser");
+			lua_pushinteger(L, stats.fWasm);
+			lua_setfield(L, -2, "wasm");
+			lua_pushinteger(L, stats.fSync);
+			lua_setfield(L, -2, "sync");
+			lua_pushinteger(L, stats.fFallback);
+			lua_setfield(L, -2, "fallback");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "bitmapCacheSize") == 0)
+		{
+			lua_pushnumber(L, (lua_Number) EmscriptenBitmapCache::Instance().GetBudget());
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "bitmapCacheStats") == 0)
+		{
+			EmscriptenBitmapCache::Stats stats = EmscriptenBitmapCache::Instance().GetStats();
+			lua_createtable(L, 0, 5);
+			lua_pushinteger(L, stats.fHits);
+			lua_setfield(L, -2, "hits");
+			lua_pushinteger(L, stats.fMisses);
+			lua_setfield(L, -2, "misses");
+			lua_pushinteger(L, stats.fEvictions);
+			lua_setfield(L, -2, "evictions");
+			lua_pushnumber(L, (lua_Number) stats.fBytes);
+			lua_setfield(L, -2, "bytes");
+			lua_pushinteger(L, (int) stats.fCount);
+			lua_setfield(L, -2, "count");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "bitmapMemory") == 0)
+		{
+			// pixels kept in the heap and pixels freed after upload
+			EmscriptenBaseBitmap::MemoryStats stats = EmscriptenBaseBitmap::GetMemoryStats();
+			lua_createtable(L, 0, 3);
+			lua_pushnumber(L, (lua_Number) stats.fResident);
+			lua_setfield(L, -2, "resident");
+			lua_pushnumber(L, (lua_Number) stats.fReleased);
+			lua_setfield(L, -2, "released");
+			lua_pushinteger(L, stats.fRestores);
+			lua_setfield(L, -2, "restores");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "imageSaveOptions") == 0)
+		{
+			lua_createtable(L, 0, 3);
+			lua_pushboolean(L, EmscriptenSaveQueue::Instance().IsAsync());
+			lua_setfield(L, -2, "async");
+			lua_pushboolean(L, EmscriptenSaveQueue::IsThreaded());
+			lua_setfield(L, -2, "threaded");
+			lua_pushinteger(L, EmscriptenImageEncoder::GetPNGCompression());
+			lua_setfield(L, -2, "pngCompression");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "imageMaxSize") == 0)
+		{
+			lua_pushinteger(L, EmscriptenImageDecoder::GetMaxSize(false));
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "textRenderer") == 0)
+		{
+			lua_pushstring(L, EmscriptenGlyphAtlas::Instance().IsEnabled() ? "native" : "canvas");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "textCacheSize") == 0)
+		{
+			lua_pushnumber(L, (lua_Number) EmscriptenTextCache::Instance().GetBudget());
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "textCacheStats") == 0)
+		{
+			EmscriptenTextCache::Stats stats = EmscriptenTextCache::Instance().GetStats();
+			U32 lookups = stats.fHits + stats.fMisses;
+			lua_createtable(L, 0, 6);
+			lua_pushinteger(L, stats.fHits);
+			lua_setfield(L, -2, "hits");
+			lua_pushinteger(L, stats.fMisses);
+			lua_setfield(L, -2, "misses");
+			lua_pushnumber(L, lookups > 0 ? (lua_Number) stats.fHits / lookups : 0);
+			lua_setfield(L, -2, "hitRate");
+			lua_pushinteger(L, stats.fEvictions);
+			lua_setfield(L, -2, "evictions");
+			lua_pushnumber(L, (lua_Number) stats.fBytes);
+			lua_setfield(L, -2, "bytes");
+			lua_pushinteger(L, (int) stats.fCount);
+			lua_setfield(L, -2, "count");
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "textAtlasStats") == 0)
+		{
+			EmscriptenGlyphAtlas::Stats stats = EmscriptenGlyphAtlas::Instance().GetStats();
+			lua_createtable(L, 0, 3);
+			lua_pushinteger(L, stats.fGlyphs);
+			lua_setfield(L, -2, "glyphs");
+			lua_pushinteger(L, stats.fFonts);
+			lua_setfield(L, -2, "fonts");
+			lua_pushinteger(L, stats.fResets);
+			lua_setfield(L, -2, "resets");
+			pushedValues = 1;
+		}
 		else
 		{
 			// The given key is unknown. Log a warning.
@@ -873,6 +1186,48 @@ namespace Rtt
 			lua_pushstring(L, "isoLanguageCode");	// todo
 			pushedValues = 1;
 		}
+		else if (Rtt_StringCompare(key, "networkDownlink") == 0)
+		{
+			// Effective bandwidth estimate in Mbit/s, nil if the browser does not report it.
+			double downlink = EmscriptenReachability::GetDownlink();
+			if (downlink >= 0)
+			{
+				lua_pushnumber(L, downlink);
+			}
+			else
+			{
+				lua_pushnil(L);
+			}
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "networkRTT") == 0)
+		{
+			// Round trip time estimate in milliseconds, nil if the browser does not report it.
+			int rtt = EmscriptenReachability::GetRTT();
+			if (rtt >= 0)
+			{
+				lua_pushinteger(L, rtt);
+			}
+			else
+			{
+				lua_pushnil(L);
+			}
+			pushedValues = 1;
+		}
+		else if (Rtt_StringCompare(key, "networkEffectiveType") == 0)
+		{
+			// One of "slow-2g", "2g", "3g" or "4g", nil if the browser does not report it.
+			std::string type = EmscriptenReachability::GetEffectiveType();
+			if (type.empty())
+			{
+				lua_pushnil(L);
+			}
+			else
+			{
+				lua_pushstring(L, type.c_str());
+			}
+			pushedValues = 1;
+		}
 		else
 		{
 			// Push nil if given a key that is unknown on this platform.
@@ -906,12 +1261,12 @@ namespace Rtt
 
 	PlatformReachability* EmscriptenPlatform::NewReachability(const ResourceHandle<lua_State>& handle, PlatformReachability::PlatformReachabilityType type, const char* address) const
 	{
-		return Rtt_NEW(fAllocator, PlatformReachability(handle, type, address));
+		return Rtt_NEW(fAllocator, EmscriptenReachability(handle, type, address));
 	}
 
 	bool EmscriptenPlatform::SupportsNetworkStatus() const
 	{
-		return false;
+		return true;
 	}
 
 	PlatformBitmap* EmscriptenPlatform::CreateBitmapMask(const char str[], const PlatformFont& font, Real w, Real h, const char alignment[], Real& baselineOffset) const
@@ -922,12 +1277,13 @@ namespace Rtt
 
 	FontMetricsMap EmscriptenPlatform::GetFontMetrics(const PlatformFont& font) const
 	{
+		EmscriptenTextMetrics::Metrics m = EmscriptenTextMetrics::GetMetrics(font.Name(), font.Size());
+
 		FontMetricsMap ret;
-		ret["ascent"] = font.Size(); //TTF_FontAscent(f);
-		ret["descent"] = 0; //TTF_FontDescent(f);
-		ret["leading"] = 0; //TTF_FontLineSkip(f) - TTF_FontHeight(f);
-		ret["height"] = 0; //TTF_FontHeight(f);
-		Rtt_LogException("GetFontMetrics is not implemented yet");
+		ret["ascent"] = m.fAscent;
+		ret["descent"] = m.fDescent;
+		ret["leading"] = m.fLeading;
+		ret["height"] = m.fHeight;
 		return ret;
 	}
 
@@ -989,6 +1345,8 @@ namespace Rtt
 
 	void EmscriptenPlatform::Suspend() const
 	{
+		// a hidden tab is the browser's hint to give memory back
+		EmscriptenBitmapCache::Instance().Clear();
 	}
 
 	void EmscriptenPlatform::Resume() const
@@ -477,13 +477,11 @@ var platformLibrary =
 	// context
 	//
 
-	jsContextLoadFonts: function(_name, buf, size)
+	// Fonts are read from the preloaded file system with one native copy and registered with FontFace,
+	// all of them load in parallel while the app waits for Module.loadingFonts to reach 0
+	jsContextLoadFonts: function(_name)
 	{
 		var name = UTF8ToString(_name);
-		var body = new Uint8Array(size);
-		for (var i = 0; i < size; i++) {
-			body[i] = getValue(buf + i, 'i8');
-		}
 
 		var a = name.split('/');
 		var b = a[a.length - 1];		// filename
@@ -497,30 +495,54 @@ var platformLibrary =
 		var fontName = c[0];
 //		console.log('jsContextLoadFonts:', name, fontName, fontType);
 
-		var blob = new Blob([body], { type: ("font/" + fontType) });
-		var url = URL.createObjectURL(blob);
-		var rule = '@font-face { font-family: "' + fontName + '";	src: url("' + url + '") format("truetype"); }';
-
-		// declare font
-		var fontface = document.createElement('style');
-		fontface.appendChild(document.createTextNode(rule))
-		document.head.appendChild(fontface);
+		var body;
+		try {
+			body = FS.readFile(name);
+		}
+		catch (e) {
+			console.log('jsContextLoadFonts: Failed to read ', name);
+			return 0;
+		}
 
+		// the outcome is known here, text rendering does not have to test the font
 		function onFontLoaded() {
 			//console.log('font ' + fontName + ' loaded');
+			jsTextFontFamilies()[fontName] = true;
 			Module.loadingFonts--;
 		};
 
 		function onFontFailed() {
 			console.log('Failed to load font:', fontName);
+			jsTextFontFamilies()[fontName] = false;
 			Module.loadingFonts--;
 		}
 
+		if (!Module.loadingFonts) {
+			Module.loadingFonts = 0;
+		}
+
+		// FontFace parses the bytes directly, no blob URL and no style sheet
+		if (typeof(FontFace) == 'function' && document.fonts && typeof(document.fonts.add) == 'function') {
+			Module.loadingFonts++;
+			var face = new FontFace(fontName, body);
+			face.load().then(function (loaded) {
+				document.fonts.add(loaded);
+				onFontLoaded();
+			}, onFontFailed);
+			return 1;
+		}
+
+		var blob = new Blob([body], { type: ("font/" + fontType) });
+		var url = URL.createObjectURL(blob);
+		var rule = '@font-face { font-family: "' + fontName + '";	src: url("' + url + '") format("truetype"); }';
+
+		// declare font
+		var fontface = document.createElement('style');
+		fontface.appendChild(document.createTextNode(rule))
+		document.head.appendChild(fontface);
+
 		// load font
 		if (document.fonts && typeof(document.fonts.load) == 'function') {
-			if (!Module.loadingFonts) {
-				Module.loadingFonts = 0;
-			}
 			Module.loadingFonts++;
 			document.fonts.load('72px "' + fontName + '"').then(onFontLoaded, onFontFailed);
 			console.log('loading ', name);
@@ -705,14 +727,17 @@ var platformLibrary =
 		var method = UTF8ToString(_method);
 		var headers = UTF8ToString(_headers);
 
-		// get body
-		var body = new Uint8Array(body_size);
-		for (var i = 0; i < body_size; i++) {
-			body[i] = getValue(_body + i, 'i8');
-		}
+		// get body, one copy out of the heap
+		var body = HEAPU8.slice(_body, _body + body_size);
 
 		//console.log('network.request==> url:', url, ' method:', method, ' headers:', headers, ' _body:', _body, ' body_size:', body_size, ' hash:', key, body);
 
+		// network.download() of a GET request can be resumed after a failure
+		if (method == 'GET' && progress == 2 && typeof fetch == 'function' && typeof ReadableStream != 'undefined') {
+			jsNetworkResumableDownload(url, headers, _requestPtr);
+			return 0;
+		}
+
 		var xml = new XMLHttpRequest();
 		xml.url = url;		// save for callback
 		xml.responseType = "arraybuffer";
@@ -723,32 +748,357 @@ var platformLibrary =
 
 			switch (this.readyState) {
 				case XMLHttpRequest.DONE:			// val=4
+					var body = this.response ? new Uint8Array(this.response) : new Uint8Array();
+					jsNetworkDispatchDone(_requestPtr, this.status, body, this.getAllResponseHeaders() || "");
+					break;
+
+				default:
+					break;
+			}
+		};
+
+		xml.open(method, url, true);		// async request
+		jsNetworkParseHeaders(headers, function (hkey, hval) {
+			xml.setRequestHeader(hkey, hval);
+		});
+
+		xml.send(body);
+		return xml;
+	},
 
-					var body = new Uint8Array();
-					if (this.response) {
-						body = new Uint8Array(this.response);
+	// Sends the file at path as the request body, see Rtt_EmscriptenNetworkUpload.h.
+	// A fetch with a ReadableStream body reads one chunk from the file whenever the browser asks for more data.
+	// Streamed request bodies need HTTP/2; browsers without them, or a fetch rejected for it, get an XMLHttpRequest
+	// with a view on the file's contents instead, which the browser copies when sending.
+	// Progress is reported through jsNetworkUploadProgress once per chunk.
+	jsNetworkRequestFile: function (_url, _method, _headers, _path, _requestPtr, progress) {
+		var url = UTF8ToString(_url);
+		var method = UTF8ToString(_method);
+		var headers = UTF8ToString(_headers);
+		var path = UTF8ToString(_path);
+		var chunkSize = Module.networkUploadChunkSize || 1024 * 1024;
+
+		var total;
+		try {
+			total = FS.stat(path).size;
+		}
+		catch (e) {
+			Module.printErr('Error: Failed to open ' + path + '\n', e);
+			return 0;
+		}
+
+		function reportProgress(sent) {
+			if (progress) {
+				_jsNetworkUploadProgress(progress, _requestPtr, sent, total);
+			}
+		}
+
+		function sendStream() {
+			var stream = FS.open(path, 'r');
+			var sent = 0;
+			var body = new ReadableStream({
+				pull: function (controller) {
+					var n = Math.min(chunkSize, total - sent);
+					if (n <= 0) {
+						FS.close(stream);
+						stream = null;
+						controller.close();
+						return;
 					}
 
-					var headers = this.getAllResponseHeaders();
-					if (!headers) {
-						headers = "";
+					// a chunk is handed over to the browser, so every one needs a buffer of its own
+					var chunk = new Uint8Array(n);
+					FS.read(stream, chunk, 0, n, sent);
+					sent += n;
+					controller.enqueue(chunk);
+					reportProgress(sent);
+				},
+				cancel: function () {
+					if (stream) {
+						FS.close(stream);
+						stream = null;
 					}
+				}
+			}, { highWaterMark: 0 });
 
-					var cheaders = Module.jstr2cstr(headers);
-					var cbody = Module.jarray2carray(body);
-					_jsNetworkDispatch(_requestPtr, this.readyState, this.status, body.byteLength, cbody, cheaders);
-					_free(cbody);
-					_free(cheaders);
-					break;
+			var requestHeaders = new Headers();
+			jsNetworkParseHeaders(headers, function (hkey, hval) {
+				requestHeaders.set(hkey, hval);
+			});
 
-				default:
-					break;
+			fetch(url, { method: method, headers: requestHeaders, body: body, duplex: 'half' }).then(function (response) {
+				var responseHeaders = jsNetworkResponseHeaders(response);
+				return response.arrayBuffer().then(function (buf) {
+					jsNetworkDispatchDone(_requestPtr, response.status, new Uint8Array(buf), responseHeaders);
+				},
+				function (err) {
+					jsNetworkDispatchDone(_requestPtr, 0, new Uint8Array(), '');
+				});
+			},
+			function (err) {
+				if (stream) {
+					FS.close(stream);
+					stream = null;
+				}
+
+				// streamed bodies are refused over HTTP/1.1, a real network failure fails the XMLHttpRequest as well
+				sendXHR();
+			});
+		}
+
+		function sendXHR() {
+			// MEMFS keeps the file in one typed array, send a view on the used part
+			var node = FS.lookupPath(path).node;
+			var body = (node.contents && node.contents.subarray) ? node.contents.subarray(0, total) : FS.readFile(path);
+
+			var xml = new XMLHttpRequest();
+			xml.responseType = "arraybuffer";
+			xml.onreadystatechange = function () {
+				if (this.readyState == XMLHttpRequest.DONE) {
+					var body = this.response ? new Uint8Array(this.response) : new Uint8Array();
+					jsNetworkDispatchDone(_requestPtr, this.status, body, this.getAllResponseHeaders() || "");
+				}
+			};
+
+			var reported = 0;
+			xml.upload.onprogress = function (event) {
+				if (event.loaded - reported >= chunkSize || (event.loaded == total && reported < total)) {
+					reported = event.loaded;
+					reportProgress(event.loaded);
+				}
+			};
+
+			xml.open(method, url, true);
+			jsNetworkParseHeaders(headers, function (hkey, hval) {
+				xml.setRequestHeader(hkey, hval);
+			});
+			xml.send(body);
+		}
+
+		if (Module.networkRequestStreams === undefined) {
+			// the browser reads 'duplex' only if it supports streamed bodies, otherwise the stream is sent as text
+			var duplexRead = false;
+			try {
+				var hasContentType = new Request('data:,', {
+					method: 'POST',
+					body: new ReadableStream(),
+					get duplex() {
+						duplexRead = true;
+						return 'half';
+					}
+				}).headers.has('Content-Type');
+				Module.networkRequestStreams = duplexRead && !hasContentType;
+			}
+			catch (e) {
+				Module.networkRequestStreams = false;
 			}
+		}
+
+		if (Module.networkRequestStreams && typeof fetch == 'function') {
+			sendStream();
+		}
+		else {
+			sendXHR();
+		}
+		return 1;
+	},
+
+	//
+	// Socket, LuaSocket TCP over a WebSocket proxy
+	//
+
+	// proxy URL may contain '{host}' and '{port}', otherwise they are appended as query parameters
+	jsSocketConnect: function (_proxy, _host, port, thiz) {
+		var host = UTF8ToString(_host);
+		var url = UTF8ToString(_proxy) || Module.websocketProxy || 'ws://localhost:8080/';
+		if (url.indexOf('{host}') >= 0 || url.indexOf('{port}') >= 0) {
+			url = url.replace('{host}', encodeURIComponent(host)).replace('{port}', port);
+		} else {
+			url += (url.indexOf('?') >= 0 ? '&' : '?') + 'host=' + encodeURIComponent(host) + '&port=' + port;
+		}
+
+		var ws;
+		try {
+			ws = new WebSocket(url, ['binary']);
+		} catch (e) {
+			Module.printErr('Error: socket.connect failed\n', e);
+			return 0;
+		}
+		ws.binaryType = 'arraybuffer';
+		ws.thiz = thiz;
+
+		// incoming data is copied to a per-socket scratch buffer which grows as needed
+		ws.scratch = 0;
+		ws.scratchSize = 0;
+
+		ws.onopen = function () {
+			if (this.thiz) _jsSocketCallback(this.thiz, 1);
+		};
+		ws.onclose = function () {
+			if (this.thiz) _jsSocketCallback(this.thiz, 2);
+		};
+		ws.onerror = function () {
+			if (this.thiz) _jsSocketCallback(this.thiz, 3);
+		};
+		ws.onmessage = function (event) {
+			if (!this.thiz) return;
+			var data = (typeof event.data === 'string') ? new TextEncoder().encode(event.data) : new Uint8Array(event.data);
+			if (data.length == 0) return;
+			if (data.length > this.scratchSize) {
+				_free(this.scratch);
+				this.scratchSize = Math.max(data.length, 2 * this.scratchSize, 4096);
+				this.scratch = _malloc(this.scratchSize);
+			}
+			HEAPU8.set(data, this.scratch);
+			_jsSocketReceive(this.thiz, this.scratch, data.length);
 		};
 
-		xml.open(method, url, true);		// async request
+		// sockets have their own table, a closed socket is removed from it
+		Module.appSockets = Module.appSockets || {};
+		Module.appSocketCounter = (Module.appSocketCounter || 0) + 1;
+		Module.appSockets[Module.appSocketCounter] = ws;
+		return Module.appSocketCounter;
+	},
 
-		// key + ": " + value + "\r\n";
+	jsSocketSend: function (id, buf, size) {
+		var ws = Module.appSockets[id];
+		if (ws && ws.readyState == 1) {
+			ws.send(HEAPU8.slice(buf, buf + size));
+			return size;
+		}
+		return 0;
+	},
+
+	// bytes queued by send() and not yet handed to the network
+	jsSocketBufferedAmount: function (id) {
+		var ws = Module.appSockets[id];
+		return ws ? ws.bufferedAmount : 0;
+	},
+
+	jsSocketClose: function (id) {
+		var ws = Module.appSockets[id];
+		if (ws) {
+			ws.thiz = null;
+			ws.close();
+			_free(ws.scratch);
+			ws.scratch = 0;
+			delete Module.appSockets[id];
+		}
+	},
+
+	//
+	// Network status
+	//
+
+	jsReachabilityStart: function (thiz) {
+		var listener = {
+			thiz: thiz,
+			handler: function () {
+				if (listener.thiz) _jsReachabilityChanged(listener.thiz);
+			}
+		};
+		window.addEventListener('online', listener.handler);
+		window.addEventListener('offline', listener.handler);
+		var connection = navigator.connection || navigator.mozConnection || navigator.webkitConnection;
+		if (connection && connection.addEventListener) {
+			connection.addEventListener('change', listener.handler);
+		}
+
+		Module.appObjects.push(listener);
+		return Module.appObjects.length;	// id = index + 1
+	},
+
+	jsReachabilityStop: function (id) {
+		var listener = Module.appObjects[id - 1];
+		if (listener) {
+			listener.thiz = null;
+			window.removeEventListener('online', listener.handler);
+			window.removeEventListener('offline', listener.handler);
+			var connection = navigator.connection || navigator.mozConnection || navigator.webkitConnection;
+			if (connection && connection.removeEventListener) {
+				connection.removeEventListener('change', listener.handler);
+			}
+			Module.appObjects[id - 1] = null;
+		}
+	},
+
+	// see EmscriptenReachability::ConnectionType
+	jsReachabilityType: function () {
+		if (!navigator.onLine) {
+			return 0;
+		}
+		var connection = navigator.connection || navigator.mozConnection || navigator.webkitConnection;
+		var type = connection ? connection.type : undefined;
+		if (type == 'none') {
+			return 0;
+		}
+		if (type == 'wifi' || type == 'wimax') {
+			return 1;
+		}
+		if (type == 'cellular') {
+			return 2;
+		}
+		return 3;
+	},
+
+	jsNetworkDownlink: function () {
+		var connection = navigator.connection || navigator.mozConnection || navigator.webkitConnection;
+		return (connection && typeof connection.downlink == 'number') ? connection.downlink : -1;
+	},
+
+	jsNetworkRTT: function () {
+		var connection = navigator.connection || navigator.mozConnection || navigator.webkitConnection;
+		return (connection && typeof connection.rtt == 'number') ? connection.rtt : -1;
+	},
+
+	jsNetworkEffectiveType: function (buf, size) {
+		var connection = navigator.connection || navigator.mozConnection || navigator.webkitConnection;
+		stringToUTF8((connection && connection.effectiveType) || '', buf, size);
+	},
+
+	//
+	// Image decoding
+	//
+
+	jsCanDecodeImages: function () {
+		return (typeof createImageBitmap == 'function' && (typeof OffscreenCanvas != 'undefined' || typeof document != 'undefined')) ? 1 : 0;
+	},
+
+	// Decodes the file with createImageBitmap off the main thread, straight RGBA comes back through jsDecodeQueueDone.
+	// Every outcome is reported from a promise callback, never synchronously.
+	jsDecodeImage: function (_path, job) {
+		var path = UTF8ToString(_path);
+		new Promise(function (resolve) {
+			resolve(FS.readFile(path));
+		}).then(function (bytes) {
+			return createImageBitmap(new Blob([bytes]), { premultiplyAlpha: 'none', colorSpaceConversion: 'none' });
+		}).then(function (bitmap) {
+			var w = bitmap.width;
+			var h = bitmap.height;
+			var canvas;
+			if (typeof OffscreenCanvas != 'undefined') {
+				canvas = new OffscreenCanvas(w, h);
+			} else {
+				canvas = document.createElement('canvas');
+				canvas.width = w;
+				canvas.height = h;
+			}
+			var ctx = canvas.getContext('2d');
+			ctx.drawImage(bitmap, 0, 0);
+			bitmap.close();
+
+			return ctx.getImageData(0, 0, w, h);
+		}).then(function (image) {
+			var buf = _malloc(image.data.length);
+			HEAPU8.set(image.data, buf);
+			_jsDecodeQueueDone(job, buf, image.width, image.height);
+		}, function (e) {
+			_jsDecodeQueueDone(job, 0, 0, 0);
+		});
+	},
+
+	// headers is "key: value|key: value", set(key, value) is called for every complete pair
+	$jsNetworkParseHeaders: function (headers, set) {
 		var hlines = headers.split("|");
 		for (var i = 0; i < hlines.length; i++) {
 			var pair = hlines[i].split(': ');
@@ -756,14 +1106,251 @@ var platformLibrary =
 				var hkey = pair[0].trim();
 				var hval = pair[1].trim();
 				if (hkey.length > 0 && hval.length > 0) {
-					xml.setRequestHeader(hkey, hval);
-					//console.log('setRequestHeader:', hkey, '=', hval);
+					set(hkey, hval);
 				}
 			}
 		}
+	},
 
-		xml.send(body);
-		return xml;
+	// Headers of a fetch response as getAllResponseHeaders() returns them
+	$jsNetworkResponseHeaders: function (response) {
+		var s = '';
+		response.headers.forEach(function (val, key) {
+			s += key + ': ' + val + '\r\n';
+		});
+		return s;
+	},
+
+	// Passes a finished request to the network plugin
+	$jsNetworkDispatchDone: function (_requestPtr, status, body, headers) {
+		var cheaders = Module.jstr2cstr(headers);
+		var cbody = Module.jarray2carray(body);
+		_jsNetworkDispatch(_requestPtr, XMLHttpRequest.DONE, status, body.byteLength, cbody, cheaders);
+		_free(cbody);
+		_free(cheaders);
+	},
+
+	// Downloads url into a partial file.
+	// The sidecar file keeps the validator (ETag / Last-Modified) and the received offset,
+	// so a failed transfer is continued with 'Range' instead of starting from zero.
+	// 'If-Range' is sent to the same origin only, it is not CORS-safelisted and would need a preflight;
+	// a cross-origin 206 is checked against the validator instead.
+	// A partial file the server rejects (416, a 206 starting elsewhere or of another version) is deleted and downloaded again,
+	// so is one whose ranged request fails at the network level while online.
+	// Retries use exponential backoff, the complete body is passed to jsNetworkDispatch as usual.
+	$jsNetworkResumableDownload: function (url, headers, _requestPtr) {
+		// the temporary directory is in memory, partial files survive a reload only in the IDBFS mount, synced on unload
+		var dir = Module.networkResumeDir || (Module.documentsDirLoaded ? '/documentsDir/.corona_downloads' : '/tmp');
+		var maxRetries = Module.networkMaxRetries || 5;
+		var retryDelay = Module.networkRetryDelay || 500;		// msec, doubled on every retry
+		var maxRetryDelay = 30000;
+		var metaInterval = 256 * 1024;		// the sidecar offset is saved every metaInterval bytes
+		var attempt = 0;
+
+		// djb2 hash of url as file name
+		var hash = 5381;
+		for (var i = 0; i < url.length; i++) {
+			hash = ((hash << 5) + hash + url.charCodeAt(i)) >>> 0;
+		}
+		try { FS.mkdir(dir); } catch (e) {}		// may exist already
+
+		// a download of a url which is being downloaded already gets a file of its own
+		Module.appDownloadParts = Module.appDownloadParts || {};
+		var base = dir + '/corona_download_' + hash.toString(16);
+		var partPath = base + '.part';
+		for (var n = 1; Module.appDownloadParts[partPath]; n++) {
+			partPath = base + '_' + n + '.part';
+		}
+		Module.appDownloadParts[partPath] = true;
+		var metaPath = partPath + '.json';
+
+		function readMeta() {
+			try {
+				var meta = JSON.parse(FS.readFile(metaPath, { encoding: 'utf8' }));
+				if (meta.url == url) {
+					// trust the partial file, not the sidecar
+					meta.offset = Math.min(meta.offset, FS.stat(partPath).size);
+					return meta;
+				}
+			}
+			catch (e) {
+			}
+			return null;
+		}
+
+		function writeMeta(meta) {
+			try {
+				FS.writeFile(metaPath, JSON.stringify(meta));
+			}
+			catch (e) {
+				Module.printErr('Error: Failed to write ' + metaPath + '\n', e);
+			}
+		}
+
+		function discard() {
+			try { FS.unlink(partPath); } catch (e) {}
+			try { FS.unlink(metaPath); } catch (e) {}
+		}
+
+		var sameOrigin = false;
+		try {
+			sameOrigin = (new URL(url, location.href).origin == location.origin);
+		}
+		catch (e) {
+		}
+
+		// If-Range accepts only strong validators, a cross-origin ETag is readable only if the server exposes it
+		function validatorOf(response) {
+			var etag = response.headers.get('ETag');
+			return (etag && etag.indexOf('W/') != 0) ? etag : response.headers.get('Last-Modified');
+		}
+
+		function dispatch(status, body, headers) {
+			delete Module.appDownloadParts[partPath];
+			jsNetworkDispatchDone(_requestPtr, status, body, headers);
+		}
+
+		// Passes the complete file as a 200 response, read once straight into the heap
+		function dispatchFile(response) {
+			delete Module.appDownloadParts[partPath];
+			var size = FS.stat(partPath).size;
+			var cbody = _malloc(Math.max(size, 1));
+			var stream = FS.open(partPath, 'r');
+			FS.read(stream, HEAPU8, cbody, size, 0);
+			FS.close(stream);
+			discard();
+
+			// the headers of a resumed 206 describe the last range only
+			var headers = '';
+			response.headers.forEach(function (val, key) {
+				if (key != 'content-range' && key != 'content-length') {
+					headers += key + ': ' + val + '\r\n';
+				}
+			});
+			headers += 'content-length: ' + size + '\r\n';
+
+			var cheaders = Module.jstr2cstr(headers);
+			_jsNetworkDispatch(_requestPtr, XMLHttpRequest.DONE, 200, size, cbody, cheaders);
+			_free(cbody);
+			_free(cheaders);
+		}
+
+		// the partial file does not match the resource, download it again without 'Range'
+		function restart(response) {
+			if (response.body) {
+				response.body.cancel();
+			}
+			discard();
+			start();
+		}
+
+		// the partial file is kept, so the next network.download() of the same url resumes it
+		function retry(status, body, headers) {
+			if (attempt < maxRetries) {
+				var delay = Math.min(retryDelay * Math.pow(2, attempt), maxRetryDelay);
+				attempt++;
+				setTimeout(start, delay);
+			}
+			else {
+				dispatch(status, body, headers);
+			}
+		}
+
+		function start() {
+			var requestHeaders = new Headers();
+			jsNetworkParseHeaders(headers, function (hkey, hval) {
+				requestHeaders.set(hkey, hval);
+			});
+
+			var meta = readMeta();
+			if (meta && meta.offset > 0 && meta.validator) {
+				requestHeaders.set('Range', 'bytes=' + meta.offset + '-');
+				if (sameOrigin) {
+					requestHeaders.set('If-Range', meta.validator);
+				}
+			}
+			else {
+				discard();
+				meta = null;
+			}
+
+			fetch(url, { method: 'GET', headers: requestHeaders }).then(function (response) {
+				var headers = jsNetworkResponseHeaders(response);
+				if (response.status == 416 && meta != null) {
+					restart(response);
+					return;
+				}
+				if (!response.ok) {
+					return response.arrayBuffer().then(function (buf) {
+						// server errors are worth retrying, client errors are not
+						if (response.status >= 500) {
+							retry(response.status, new Uint8Array(buf), headers);
+						}
+						else {
+							dispatch(response.status, new Uint8Array(buf), headers);
+						}
+					});
+				}
+
+				// 200 means the server ignored 'Range' or the resource has changed
+				var resumed = (response.status == 206 && meta != null);
+				if (resumed) {
+					// 'bytes first-last/length', the body must continue exactly where the partial file ends
+					var range = /^bytes (\d+)-/.exec(response.headers.get('Content-Range') || '');
+					if (range == null || parseInt(range[1], 10) != meta.offset || validatorOf(response) != meta.validator) {
+						restart(response);
+						return;
+					}
+				}
+				else {
+					discard();
+					meta = { url: url, validator: validatorOf(response), offset: 0 };
+				}
+				writeMeta(meta);
+
+				// the sidecar never claims more than the partial file holds, even if the tab is closed
+				var stream = FS.open(partPath, resumed ? 'a' : 'w');
+				var reader = response.body.getReader();
+				var saved = meta.offset;
+				var pump = function () {
+					return reader.read().then(function (result) {
+						if (result.done) {
+							return;
+						}
+						FS.write(stream, result.value, 0, result.value.length);
+						meta.offset += result.value.length;
+						if (meta.offset - saved >= metaInterval) {
+							writeMeta(meta);
+							saved = meta.offset;
+						}
+						return pump();
+					});
+				};
+
+				return pump().then(
+					function () {
+						FS.close(stream);
+						dispatchFile(response);
+					},
+					function (err) {
+						FS.close(stream);
+						writeMeta(meta);
+						retry(0, new Uint8Array(), '');
+					});
+			},
+			function (err) {
+				// a rejected preflight or a server that fails on 'Range' would keep the partial file forever
+				if (meta != null && navigator.onLine !== false) {
+					discard();
+				}
+				retry(0, new Uint8Array(), '');
+			})
+			.catch(function (err) {
+				retry(0, new Uint8Array(), '');
+			});
+		}
+
+		start();
 	},
 
 	// Measures text by creating a DIV in the document and adding the relevant text to it.
@@ -801,77 +1388,274 @@ var platformLibrary =
 	//
 	// text render
 	//
-	jsRenderText: function (thiz, _text, w, h, _alignment, _fontName, fontSize) {
-		var text = UTF8ToString(_text);
-		var alignment = UTF8ToString(_alignment);
+	// one canvas reused by every text render, grown to the largest text so far up to
+	// Module.textCanvasMaxPixels (1M by default). A larger text gets a canvas of its own which is dropped
+	// after the render, so one full-screen paragraph does not pin a huge backing store for the session.
+	// Resizing clears the canvas and resets the context state, callers set the font after this.
+	$jsTextCanvas: function (w, h) {
+		var maxPixels = Module.textCanvasMaxPixels || 1024 * 1024;
+		var newCanvas = function (cw, ch) {
+			if (typeof OffscreenCanvas !== 'undefined') {
+				return new OffscreenCanvas(cw, ch);
+			}
+			var c = document.createElement('canvas');
+			c.width = cw;
+			c.height = ch;
+			return c;
+		};
+
+		if (w * h > maxPixels) {
+			return newCanvas(w, h).getContext('2d', { willReadFrequently: true });
+		}
+
+		var pool = Module.appTextCanvas;
+		if (!pool) {
+			pool = Module.appTextCanvas = { canvas: newCanvas(w, h), ctx: null };
+		}
+
+		// grown to the largest text so far, never beyond maxPixels
+		var c = pool.canvas;
+		if (pool.ctx == null || c.width < w || c.height < h) {
+			var cw = Math.max(c.width, w);
+			var ch = Math.max(c.height, h);
+			if (cw * ch > maxPixels) {
+				cw = w;
+				ch = h;
+			}
+			c.width = cw;
+			c.height = ch;
+			pool.ctx = c.getContext('2d', { willReadFrequently: true });
+		}
+		else {
+			pool.ctx.clearRect(0, 0, w, h);
+		}
+		return pool.ctx;
+	},
+
+	// Greedy word wrap. Words, spaces and CJK characters are measured once per font and cached,
+	// so a line is the sum of its token widths instead of re-measuring every growing substring.
+	// w == 0 means no wrapping, layout.width is then the widest line.
+	$jsTextLayout: function (ctx, text, w) {
+		var cache = Module.appTextAdvances;
+		if (!cache || cache.count > 8192) {
+			cache = Module.appTextAdvances = { count: 0, fonts: {} };
+		}
+		var advances = cache.fonts[ctx.font];
+		if (!advances) {
+			advances = cache.fonts[ctx.font] = {};
+		}
+
+		var advance = function (s) {
+			var a = advances[s];
+			if (a === undefined) {
+				a = advances[s] = ctx.measureText(s).width;
+				cache.count++;
+			}
+			return a;
+		};
+
+		// CJK, kana, hangul and fullwidth forms break between any two characters
+		var isBreakable = function (c) {
+			return (c >= 0x2E80 && c <= 0x9FFF) || (c >= 0xAC00 && c <= 0xD7AF) || (c >= 0xF900 && c <= 0xFAFF) || (c >= 0xFF00 && c <= 0xFFEF);
+		};
+
+		var tokenize = function (s) {
+			var tokens = [];
+			var word = '';
+			for (var i = 0; i < s.length; i++) {
+				var ch = s.charAt(i);
+				if (ch === ' ' || isBreakable(s.charCodeAt(i))) {
+					if (word.length > 0) {
+						tokens.push(word);
+						word = '';
+					}
+					tokens.push(ch);
+				}
+				else {
+					word += ch;
+				}
+			}
+			if (word.length > 0) {
+				tokens.push(word);
+			}
+			return tokens;
+		};
+
+		var lines = [];
+		var width = 0;
+		var line = '';
+		var lineWidth = 0;
+
+		// spaces before a wrap are not drawn, they would shift right and center aligned lines
+		var wrap = function () {
+			var trimmed = line.replace(/ +$/, '');
+			lines.push(trimmed);
+			width = Math.max(width, lineWidth - (line.length - trimmed.length) * advance(' '));
+			line = '';
+			lineWidth = 0;
+		};
+
+		var paragraphs = text.split('\n');
+		for (var p = 0; p < paragraphs.length; p++) {
+			var tokens = tokenize(paragraphs[p]);
+			for (var t = 0; t < tokens.length; t++) {
+				var token = tokens[t];
+				var tw = advance(token);
+				if (w == 0 || lineWidth + tw <= w) {
+					line += token;
+					lineWidth += tw;
+					continue;
+				}
+
+				if (line.length > 0) {
+					wrap();
+				}
+
+				if (token === ' ') {
+					// the space which overflows ends the line
+					continue;
+				}
+
+				if (tw <= w) {
+					line = token;
+					lineWidth = tw;
+					continue;
+				}
+
+				// a word wider than the text box is split between characters
+				var chars = Array.from(token);
+				for (var c = 0; c < chars.length; c++) {
+					var cw = advance(chars[c]);
+					if (lineWidth + cw > w && line.length > 0) {
+						wrap();
+					}
+					line += chars[c];
+					lineWidth += cw;
+				}
+			}
+
+			// explicit newline, trailing spaces are kept as typed
+			lines.push(line);
+			width = Math.max(width, lineWidth);
+			line = '';
+			lineWidth = 0;
+		}
+		return { lines: lines, width: width };
+	},
+
+	// font family ==> available, checked once per family.
+	// A font which finishes loading later turns a missing family into an available one,
+	// so missing families are checked again after 'loadingdone'
+	$jsTextFontFamilies: function () {
+		if (!Module.appFontFamilies) {
+			Module.appFontFamilies = {};
+			if (document.fonts && typeof(document.fonts.addEventListener) == 'function') {
+				document.fonts.addEventListener('loadingdone', function () {
+					var families = Module.appFontFamilies;
+					for (var name in families) {
+						if (families[name] === false) {
+							delete families[name];
+						}
+					}
+				});
+			}
+		}
+		return Module.appFontFamilies;
+	},
 
-		var fontName = UTF8ToString(_fontName);
+	// CSS family of a Corona font name: the file name without extension when the browser has that font, else sans-serif
+	$jsTextFont: function (ctx, fontName) {
 		var a = fontName.split('/');
 		var fontName = a[a.length - 1];		// filename
 
 		var a = fontName.split('.');
 		fontName = a[0];
-		var ext = a[1];
 
-		var canva = document.createElement('canvas');
-		canva.width = canvas.width;
-		canva.height = canvas.height;
-		canva.style.position = "absolute";
-		var ctx = canva.getContext("2d");
+		var families = jsTextFontFamilies();
+		var fontExist = families[fontName];
+		if (fontExist === undefined && fontName !== '') {
+			// check if font exists
+			// the text whose final pixel size I want to measure
+			var testtext = "ABCM|abcdefghijklmnopqrstuvwxyz0123456789";
 
-		if (Module.isSafari) {
-			ctx.fillStyle = 'red';
-		}
+			// specifying the baseline font
+			ctx.font = "72px monospace";
 
-		// check if font exists
-		// the text whose final pixel size I want to measure
-		var testtext = "ABCM|abcdefghijklmnopqrstuvwxyz0123456789";
+			// checking the size of the baseline text
+			var baselineSize = ctx.measureText(testtext).width;
 
-		// specifying the baseline font
-		ctx.font = "72px monospace";
+			// specifying the font whose existence we want to check
+			ctx.font = "72px '" + fontName + "', monospace";
 
-		// checking the size of the baseline text
-		var baselineSize = ctx.measureText(testtext).width;
+			// checking the size of the font we want to check
+			var newSize = ctx.measureText(testtext).width;
 
-		// specifying the font whose existence we want to check
-		ctx.font = "72px '" + fontName + "', monospace";
-
-		// checking the size of the font we want to check
-		var newSize = ctx.measureText(testtext).width;
-
-		// If the size of the two text instances is the same, the font does not exist because it is being rendered
-		fontExist = newSize != baselineSize;
+			// If the size of the two text instances is the same, the font does not exist because it is being rendered
+			fontExist = families[fontName] = newSize != baselineSize;
+		}
 
 		if (fontName === '' || fontExist == false) {
 		//	console.log(fontName + ' not found, using sans-serif');
 			fontName = 'sans-serif';		// Default value
 		}
+		return fontName;
+	},
+
+	// line advance of rendered text, the CSS line box of the font
+	$jsTextLineHeight: function (fontName, fontSize) {
+		var a = measureText("ABCM|abcdefghijklmnopqrstuvwxyz0123456789", false, fontName, fontSize);
+		return a[1];
+	},
+
+	// ascent, descent (negative, below the baseline) and line height written as 3 floats
+	jsFontMetrics: function (_fontName, fontSize, metrics) {
+		var ctx = jsTextCanvas(1, 1);
+		var fontName = jsTextFont(ctx, UTF8ToString(_fontName));
 		ctx.font = String(fontSize) + 'px ' + fontName;
 
-		ctx.textBaseline = 'top';
-		ctx.textAlign = alignment;
+		var m = ctx.measureText('Mg');
+		var ascent = fontSize * 0.8;
+		var descent = fontSize * 0.2;
+		if (m.fontBoundingBoxAscent !== undefined) {
+			ascent = m.fontBoundingBoxAscent;
+			descent = m.fontBoundingBoxDescent;
+		}
+		else if (m.actualBoundingBoxAscent !== undefined) {
+			// older browsers only have the ink bounds, taken over accented capitals and descenders
+			m = ctx.measureText('\u00C1\u00C9Mgjpqy');
+			ascent = m.actualBoundingBoxAscent;
+			descent = m.actualBoundingBoxDescent;
+		}
+
+		HEAPF32[(metrics >> 2) + 0] = ascent;
+		HEAPF32[(metrics >> 2) + 1] = -descent;
+		HEAPF32[(metrics >> 2) + 2] = jsTextLineHeight(fontName, fontSize);
+	},
 
-		var a = measureText(testtext, false, fontName, fontSize);
-		var lineHeight = a[1];
+	// size of the wrapped text as jsRenderText lays it out, without drawing it
+	jsMeasureText: function (_text, _fontName, fontSize, width, size) {
+		var ctx = jsTextCanvas(1, 1);
+		var fontName = jsTextFont(ctx, UTF8ToString(_fontName));
+		ctx.font = String(fontSize) + 'px ' + fontName;
+
+		var layout = jsTextLayout(ctx, UTF8ToString(_text), width);
+		HEAPF32[(size >> 2) + 0] = width > 0 ? width : layout.width;
+		HEAPF32[(size >> 2) + 1] = layout.lines.length * jsTextLineHeight(fontName, fontSize);
+	},
 
+	jsRenderText: function (thiz, _text, w, h, _alignment, _fontName, fontSize) {
+		var text = UTF8ToString(_text);
+		var alignment = UTF8ToString(_alignment);
+
+		// measuring does not depend on the canvas size
+		var ctx = jsTextCanvas(1, 1);
+		var fontName = jsTextFont(ctx, UTF8ToString(_fontName));
+		ctx.font = String(fontSize) + 'px ' + fontName;
+		var lineHeight = jsTextLineHeight(fontName, fontSize);
+
+		var layout = jsTextLayout(ctx, text, w);
 		if (w == 0) {
-			// calc width
-			var line = '';
-			for (var i = 0; i < text.length; i++) {
-				if (text.charAt(i) == '\n') {
-					line = '';
-				}
-				else {
-					line += text.charAt(i);
-					var metrics = ctx.measureText(line);
-					if (metrics.width > w) {
-						w = metrics.width;
-					}
-				}
-			}
-			// last line
-			var metrics = ctx.measureText(line);
-			w = Math.max(w, metrics.width);
+			w = layout.width;
 		}
 
 		var x = 0;
@@ -884,70 +1668,44 @@ var platformLibrary =
 				x = w / 2;
 			}
 
-		// wrap text
-
+		var lines = [];
 		var ww = 0;
 		var hh = 0;
-		var line = '';
-		for (var i = 0; i < text.length; i++) {
-			if (text.charAt(i) == '\n') {
-				ctx.fillText(line, x, y);
-				line = '';
-				y += lineHeight;
-			}
-			else {
-				var testLine = line + text.charAt(i);
-				var metrics = ctx.measureText(testLine);
-				if (metrics.width > w) {
-					if (text.charAt(i) === ' ') {
-						// ignore last space
-						ctx.fillText(line, x, y);
-						line = '';
-					}
-					else {
-						// delete last uncomplete word if space exists
-						var a = line.split(' ');
-						if (a.length > 1)	{
-							var line = a[a.length - 1] + text.charAt(i);	// the beginning of next line
-							a.pop();		// remove last
-							var s = a.join(' ');
-							ctx.fillText(s, x, y);
-						}
-						else{
-							// no words, draw line as is 
-							ctx.fillText(line, x, y);
-							line = text.charAt(i);	// the beginning of next line
-						}
-					}
-					y += lineHeight;
-				}
-				else {
-					line = testLine;
-				}
-			}
+		for (var i = 0; i < layout.lines.length; i++) {
+			lines.push([layout.lines[i], y]);
+			y += lineHeight;
 		}
 
-		// last line
-		ctx.fillText(line, x, y);
-
-		hh = h > 0 ? h : y + lineHeight;
-		ww = w;
+		hh = Math.max(1, Math.ceil(h > 0 ? h : y));
+		ww = Math.max(1, Math.ceil(w));
 
 		// it's needs for corona ?
 		if ((ww & 0x3) != 0) {
 			ww = (ww + 3) & -4;
 		}
 
+		// the pooled canvas is only cleared and read over the text bounds
+		ctx = jsTextCanvas(ww, hh);
+		ctx.font = String(fontSize) + 'px ' + fontName;
+		ctx.textBaseline = 'top';
+		ctx.textAlign = alignment;
+		if (Module.isSafari) {
+			ctx.fillStyle = 'red';
+		}
+		for (var i = 0; i < lines.length; i++) {
+			ctx.fillText(lines[i][0], x, lines[i][1]);
+		}
+
 		//console.log('render: ', metrics, text, w, h, ww, hh, alignment, fontName, fontSize);
 
+		// one copy into the reused heap region, the mask is packed on the C side
 		var myImageData = ctx.getImageData(0, 0, ww, hh);
-		var img = Module.jarray2carray(myImageData.data);
-		_jsEmscriptenBitmapSaveImage(thiz, myImageData.data.length, img, myImageData.width, myImageData.height, Module.isSafari);
-		_free(img);
-
-		//var body = document.getElementsByTagName("body")[0];
-		//body.appendChild(canva);
-		//canva.remove();
+		var len = myImageData.data.length;
+		var img = _jsEmscriptenTextBuffer(len);
+		if (img) {
+			HEAPU8.set(myImageData.data, img);
+			_jsEmscriptenBitmapSaveImage(thiz, len, img, myImageData.width, myImageData.height, Module.isSafari);
+		}
 	},
 
 	jsContextSetClearColor: function(r, g, b, a)
@@ -966,4 +1724,13 @@ autoAddDeps(platformLibrary, '$jsLocaleLanguage');
 autoAddDeps(platformLibrary, '$jsLocaleCountry');
 autoAddDeps(platformLibrary, '$jsLanguage');
 autoAddDeps(platformLibrary, '$measureText');
+autoAddDeps(platformLibrary, '$jsTextCanvas');
+autoAddDeps(platformLibrary, '$jsTextLayout');
+autoAddDeps(platformLibrary, '$jsTextFont');
+autoAddDeps(platformLibrary, '$jsTextFontFamilies');
+autoAddDeps(platformLibrary, '$jsTextLineHeight');
+autoAddDeps(platformLibrary, '$jsNetworkResumableDownload');
+autoAddDeps(platformLibrary, '$jsNetworkParseHeaders');
+autoAddDeps(platformLibrary, '$jsNetworkDispatchDone');
+autoAddDeps(platformLibrary, '$jsNetworkResponseHeaders');
 mergeInto(LibraryManager.library, platformLibrary);
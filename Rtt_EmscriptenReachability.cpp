@@ -0,0 +1,114 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenReachability.h"
+
+#if defined(EMSCRIPTEN)
+#include "emscripten/emscripten.h"
+
+extern "C"
+{
+	// JS ==> C callback
+	void EMSCRIPTEN_KEEPALIVE jsReachabilityChanged(Rtt::EmscriptenReachability* thiz)
+	{
+		thiz->OnChange();
+	}
+
+	extern int jsReachabilityStart(void* thiz);
+	extern void jsReachabilityStop(int id);
+	extern int jsReachabilityType();
+	extern double jsNetworkDownlink();
+	extern int jsNetworkRTT();
+	extern void jsNetworkEffectiveType(char* buf, int size);
+}
+#else
+	int jsReachabilityStart(void* thiz) { return 0; }
+	void jsReachabilityStop(int id) {}
+	int jsReachabilityType() { return Rtt::EmscriptenReachability::kOther; }
+	double jsNetworkDownlink() { return -1; }
+	int jsNetworkRTT() { return -1; }
+	void jsNetworkEffectiveType(char* buf, int size) { *buf = 0; }
+#endif
+
+namespace Rtt
+{
+
+	EmscriptenReachability::EmscriptenReachability(const ResourceHandle<lua_State>& handle, PlatformReachabilityType type, const char* address)
+		: Super(handle, type, address)
+	{
+		fID = jsReachabilityStart(this);
+	}
+
+	EmscriptenReachability::~EmscriptenReachability()
+	{
+		jsReachabilityStop(fID);
+	}
+
+	void EmscriptenReachability::OnChange() const
+	{
+		InvokeCallback();
+	}
+
+	bool EmscriptenReachability::IsValid() const
+	{
+		return true;
+	}
+
+	// The browser only knows whether any network is up, so the address is reachable when the browser is online
+	bool EmscriptenReachability::IsReachable() const
+	{
+		return jsReachabilityType() != kOffline;
+	}
+
+	bool EmscriptenReachability::IsConnectionRequired() const
+	{
+		return jsReachabilityType() == kOffline;
+	}
+
+	bool EmscriptenReachability::IsConnectionOnDemand() const
+	{
+		return false;
+	}
+
+	bool EmscriptenReachability::IsInteractionRequired() const
+	{
+		return false;
+	}
+
+	bool EmscriptenReachability::IsReachableViaCellular() const
+	{
+		return jsReachabilityType() == kCellular;
+	}
+
+	// Desktop browsers do not report the connection type, treat an unknown online connection as WiFi/LAN
+	bool EmscriptenReachability::IsReachableViaWiFi() const
+	{
+		int type = jsReachabilityType();
+		return type == kWiFi || type == kOther;
+	}
+
+	double EmscriptenReachability::GetDownlink()
+	{
+		return jsNetworkDownlink();
+	}
+
+	int EmscriptenReachability::GetRTT()
+	{
+		return jsNetworkRTT();
+	}
+
+	std::string EmscriptenReachability::GetEffectiveType()
+	{
+		char buf[16];
+		jsNetworkEffectiveType(buf, sizeof(buf));
+		return buf;
+	}
+
+}
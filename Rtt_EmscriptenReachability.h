@@ -0,0 +1,57 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md 
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include "Rtt_PlatformReachability.h"
+#include <string>
+
+namespace Rtt
+{
+
+	/// Network status from the browser's 'online'/'offline' events and navigator.connection 'change' event.
+	/// Nothing is polled, the Lua listener is invoked from the JS event handlers.
+	class EmscriptenReachability : public PlatformReachability
+	{
+	public:
+		typedef PlatformReachability Super;
+
+		// must match jsReachabilityType()
+		enum ConnectionType
+		{
+			kOffline = 0,
+			kWiFi,
+			kCellular,
+			kOther,		// ethernet or not reported by the browser
+		};
+
+		EmscriptenReachability(const ResourceHandle<lua_State>& handle, PlatformReachabilityType type, const char* address);
+		virtual ~EmscriptenReachability();
+
+		virtual bool IsValid() const;
+		virtual bool IsReachable() const;
+		virtual bool IsConnectionRequired() const;
+		virtual bool IsConnectionOnDemand() const;
+		virtual bool IsInteractionRequired() const;
+		virtual bool IsReachableViaCellular() const;
+		virtual bool IsReachableViaWiFi() const;
+
+		void OnChange() const;
+
+		// navigator.connection estimates, negative or empty when the browser does not report them
+		static double GetDownlink();		// Mbit/s
+		static int GetRTT();				// ms
+		static std::string GetEffectiveType();	// "slow-2g", "2g", "3g" or "4g"
+
+	private:
+		int fID;		// JS listener ID
+	};
+
+}
@@ -0,0 +1,195 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenSaveQueue.h"
+#include "Rtt_EmscriptenImageEncoder.h"
+#include "Rtt_EmscriptenBitmapCache.h"
+#include "Rtt_Lua.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace Rtt
+{
+
+	EmscriptenSaveQueue& EmscriptenSaveQueue::Instance()
+	{
+		static EmscriptenSaveQueue sQueue;
+		return sQueue;
+	}
+
+	EmscriptenSaveQueue::EmscriptenSaveQueue()
+		: fQuit(false)
+		, fAsync(false)
+		, fL(NULL)
+		, fListener(NULL)
+	{
+	}
+
+	EmscriptenSaveQueue::~EmscriptenSaveQueue()
+	{
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			fQuit = true;
+		}
+		fWorkAvailable.notify_all();
+		if (fWorker.joinable())
+		{
+			fWorker.join();
+		}
+#endif
+
+		// files not written yet are lost, Lua is gone at exit
+		for (size_t i = 0; i < fPending.size(); i++)
+		{
+			free(fPending[i]->fData);
+			delete fPending[i];
+		}
+		for (size_t i = 0; i < fDone.size(); i++)
+		{
+			delete fDone[i];
+		}
+	}
+
+	bool EmscriptenSaveQueue::IsThreaded()
+	{
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void EmscriptenSaveQueue::SetListener(lua_State *L, int index)
+	{
+		if (fListener)
+		{
+			CoronaLuaDeleteRef(fL, fListener);
+			fListener = NULL;
+		}
+		fL = NULL;
+
+		if (index > 0 && lua_isfunction(L, index))
+		{
+			fL = L;
+			fListener = CoronaLuaNewRef(L, index);
+		}
+	}
+
+	bool EmscriptenSaveQueue::Save(const char* path, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality)
+	{
+		// the bitmap is gone once display.save() returns
+		size_t bpp = (format == PlatformBitmap::kMask) ? 1 : ((format == PlatformBitmap::kRGB) ? 3 : 4);
+		size_t size = width * height * bpp;
+		U8* data = (U8*) malloc(size);
+		if (data == NULL)
+		{
+			return false;
+		}
+		memcpy(data, bits, size);
+
+		Job* job = new Job();
+		job->fPath = path;
+		job->fData = data;
+		job->fWidth = width;
+		job->fHeight = height;
+		job->fFormat = format;
+		job->fQuality = quality;
+		job->fResult = false;
+
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			fPending.push_back(job);
+
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+			if (!fWorker.joinable())
+			{
+				fWorker = std::thread(&EmscriptenSaveQueue::WorkerMain, this);
+			}
+#endif
+		}
+
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		fWorkAvailable.notify_one();
+#endif
+		return true;
+	}
+
+	// Writes the file, the lock is released while encoding
+	void EmscriptenSaveQueue::Encode(Job* job, std::unique_lock<std::mutex>& lock)
+	{
+		lock.unlock();
+		job->fResult = EmscriptenImageEncoder::Save(job->fPath.c_str(), job->fData, job->fWidth, job->fHeight, job->fFormat, job->fQuality);
+		free(job->fData);
+		job->fData = NULL;
+		lock.lock();
+
+		fDone.push_back(job);
+	}
+
+	void EmscriptenSaveQueue::WorkerMain()
+	{
+		std::unique_lock<std::mutex> lock(fMutex);
+		while (true)
+		{
+			while (!fQuit && fPending.empty())
+			{
+				fWorkAvailable.wait(lock);
+			}
+			if (fQuit)
+			{
+				break;
+			}
+
+			Job* job = fPending.front();
+			fPending.pop_front();
+			Encode(job, lock);
+		}
+	}
+
+	void EmscriptenSaveQueue::Poll()
+	{
+		std::vector<Job*> done;
+		{
+			std::unique_lock<std::mutex> lock(fMutex);
+
+#if !defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+			// one file per frame, the frame which captured it is not held up
+			if (!fPending.empty())
+			{
+				Job* job = fPending.front();
+				fPending.pop_front();
+				Encode(job, lock);
+			}
+#endif
+			done.swap(fDone);
+		}
+
+		for (size_t i = 0; i < done.size(); i++)
+		{
+			Job* job = done[i];
+
+			// pixels of the old file may have been cached while it was written
+			EmscriptenBitmapCache::Instance().Invalidate(job->fPath.c_str());
+			if (fListener)
+			{
+				lua_State *L = fL;
+				CoronaLuaNewEvent(L, "imageSaved");
+				lua_pushboolean(L, !job->fResult);
+				lua_setfield(L, -2, "isError");
+				lua_pushstring(L, job->fPath.c_str());
+				lua_setfield(L, -2, "filename");
+				CoronaLuaDispatchEvent(L, fListener, 0);
+			}
+			delete job;
+		}
+	}
+
+}
@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include "Corona/CoronaLua.h"
+#include "Display/Rtt_PlatformBitmap.h"
+#include "Rtt_EmscriptenDecodeQueue.h"		// Rtt_EMSCRIPTEN_DECODE_THREADS
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace Rtt
+{
+
+	// Encodes display.save() and display.captureScreen() files later when enabled with
+	// native.setProperty("imageSaveOptions", { async = true, listener = ... }).
+	// The listener gets an "imageSaved" event once the file is written.
+	// Only builds linked with -pthread encode on a worker thread. Without threads, which is the default
+	// web build, async is a deferral: each file is encoded on the main thread during a later frame.
+	// native.getProperty("imageSaveOptions").threaded tells which.
+	class EmscriptenSaveQueue
+	{
+	public:
+		static EmscriptenSaveQueue& Instance();
+
+		EmscriptenSaveQueue();
+		~EmscriptenSaveQueue();
+
+		void SetAsync(bool enabled) { fAsync = enabled; }
+		bool IsAsync() const { return fAsync; }
+
+		// true if files are encoded on a worker thread, false if async only defers encoding
+		static bool IsThreaded();
+
+		// Listener at index, 0 removes it
+		void SetListener(lua_State *L, int index);
+
+		// Drops the listener, called before the Lua state is closed
+		void ClearListener() { SetListener(fL, 0); }
+
+		// Copies the bits, returns false only if the copy fails
+		bool Save(const char* path, const U8* bits, int width, int height, PlatformBitmap::Format format, float quality);
+
+		// Main thread, once per frame: dispatches "imageSaved" events
+		void Poll();
+
+	private:
+		struct Job
+		{
+			std::string fPath;
+			U8* fData;
+			int fWidth;
+			int fHeight;
+			PlatformBitmap::Format fFormat;
+			float fQuality;
+			bool fResult;
+		};
+
+		void Encode(Job* job, std::unique_lock<std::mutex>& lock);
+		void WorkerMain();
+
+		std::mutex fMutex;
+		std::condition_variable fWorkAvailable;
+		std::deque<Job*> fPending;
+		std::vector<Job*> fDone;
+		bool fQuit;
+		bool fAsync;
+		lua_State *fL;
+		CoronaLuaRef fListener;
+
+#if defined(Rtt_EMSCRIPTEN_DECODE_THREADS)
+		std::thread fWorker;
+#endif
+	};
+
+}
@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenSkyline.h"
+#include <algorithm>
+
+namespace Rtt
+{
+
+	EmscriptenSkyline::EmscriptenSkyline(int width, int height)
+		: fWidth(width)
+		, fHeight(height)
+		, fUsedHeight(0)
+	{
+		Segment s = { 0, 0, width };
+		fSkyline.push_back(s);
+	}
+
+	int EmscriptenSkyline::Fit(size_t i, int w, int h) const
+	{
+		int x = fSkyline[i].x;
+		if (x + w > fWidth)
+		{
+			return -1;
+		}
+
+		// the rectangle rests on the highest segment it spans
+		int y = 0;
+		for (int remaining = w; remaining > 0; i++)
+		{
+			y = std::max(y, fSkyline[i].y);
+			if (y + h > fHeight)
+			{
+				return -1;
+			}
+			remaining -= fSkyline[i].width;
+		}
+		return y;
+	}
+
+	bool EmscriptenSkyline::Insert(int w, int h, int& x, int& y)
+	{
+		// bottom-left: lowest top, then narrowest segment
+		size_t best = fSkyline.size();
+		int bestTop = fHeight + 1;
+		int bestWidth = 0;
+		for (size_t i = 0; i < fSkyline.size(); i++)
+		{
+			int top = Fit(i, w, h);
+			if (top >= 0 && (top + h < bestTop || (top + h == bestTop && fSkyline[i].width < bestWidth)))
+			{
+				best = i;
+				bestTop = top + h;
+				bestWidth = fSkyline[i].width;
+			}
+		}
+		if (best == fSkyline.size())
+		{
+			return false;
+		}
+
+		x = fSkyline[best].x;
+		y = bestTop - h;
+
+		// the new segment covers the spanned ones, the last may be cut
+		Segment s = { x, bestTop, w };
+		fSkyline.insert(fSkyline.begin() + best, s);
+		size_t i = best + 1;
+		while (i < fSkyline.size() && fSkyline[i].x < x + w)
+		{
+			int overlap = x + w - fSkyline[i].x;
+			if (overlap >= fSkyline[i].width)
+			{
+				fSkyline.erase(fSkyline.begin() + i);
+			}
+			else
+			{
+				fSkyline[i].x += overlap;
+				fSkyline[i].width -= overlap;
+				break;
+			}
+		}
+
+		// merge neighbours of the same height
+		for (size_t k = 0; k + 1 < fSkyline.size(); )
+		{
+			if (fSkyline[k].y == fSkyline[k + 1].y)
+			{
+				fSkyline[k].width += fSkyline[k + 1].width;
+				fSkyline.erase(fSkyline.begin() + k + 1);
+			}
+			else
+			{
+				k++;
+			}
+		}
+
+		fUsedHeight = std::max(fUsedHeight, bestTop);
+		return true;
+	}
+
+}
@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+namespace Rtt
+{
+
+	// Skyline bottom-left rectangle packer
+	class EmscriptenSkyline
+	{
+		public:
+			EmscriptenSkyline(int width, int height);
+
+			// Returns false if a w x h rectangle does not fit
+			bool Insert(int w, int h, int& x, int& y);
+
+			// Lowest y no rectangle reaches
+			int UsedHeight() const { return fUsedHeight; }
+
+		private:
+			struct Segment
+			{
+				int x;
+				int y;
+				int width;
+			};
+
+			// top of a w x h rectangle placed at segment i, -1 if it does not fit
+			int Fit(size_t i, int w, int h) const;
+
+			std::vector<Segment> fSkyline;
+			int fWidth;
+			int fHeight;
+			int fUsedHeight;
+	};
+
+}
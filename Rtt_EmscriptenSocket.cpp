@@ -0,0 +1,709 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenSocket.h"
+#include "Rtt_Lua.h"
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#if defined(EMSCRIPTEN)
+#include "emscripten/emscripten.h"
+
+extern "C"
+{
+	// JS ==> C callbacks
+	void EMSCRIPTEN_KEEPALIVE jsSocketCallback(Rtt::EmscriptenSocket* thiz, int eventID)
+	{
+		thiz->OnEvent((Rtt::EmscriptenSocket::Event) eventID);
+	}
+
+	void EMSCRIPTEN_KEEPALIVE jsSocketReceive(Rtt::EmscriptenSocket* thiz, const U8* data, int size)
+	{
+		thiz->OnData(data, size);
+	}
+
+	extern int jsSocketConnect(const char* proxy, const char* host, int port, void* thiz);
+	extern int jsSocketSend(int id, const U8* buf, int size);
+	extern int jsSocketBufferedAmount(int id);
+	extern void jsSocketClose(int id);
+}
+#else
+	int jsSocketConnect(const char* proxy, const char* host, int port, void* thiz) { return 0; }
+	int jsSocketSend(int id, const U8* buf, int size) { return 0; }
+	int jsSocketBufferedAmount(int id) { return 0; }
+	void jsSocketClose(int id) {}
+#endif
+
+namespace Rtt
+{
+	static const char kSocketMetatable[] = "EmscriptenSocket";
+
+	//
+	// EmscriptenRingBuffer
+	//
+
+	EmscriptenRingBuffer::EmscriptenRingBuffer(size_t capacity)
+		: fData(NULL)
+		, fCapacity(0)
+		, fHead(0)
+		, fSize(0)
+	{
+		Grow(capacity);
+	}
+
+	EmscriptenRingBuffer::~EmscriptenRingBuffer()
+	{
+		free(fData);
+	}
+
+	void EmscriptenRingBuffer::Grow(size_t minCapacity)
+	{
+		size_t capacity = fCapacity > 0 ? fCapacity : 64;
+		while (capacity < minCapacity)
+		{
+			capacity <<= 1;
+		}
+
+		if (capacity == fCapacity)
+		{
+			return;
+		}
+
+		// unwrap the content to the beginning of the new buffer
+		U8* data = (U8*) malloc(capacity);
+		size_t first = std::min(fSize, fCapacity - fHead);
+		if (first > 0)
+		{
+			memcpy(data, fData + fHead, first);
+			memcpy(data + first, fData, fSize - first);
+		}
+
+		free(fData);
+		fData = data;
+		fCapacity = capacity;
+		fHead = 0;
+	}
+
+	void EmscriptenRingBuffer::Write(const U8* data, size_t size)
+	{
+		if (fSize + size > fCapacity)
+		{
+			Grow(fSize + size);
+		}
+
+		size_t tail = (fHead + fSize) & (fCapacity - 1);
+		size_t first = std::min(size, fCapacity - tail);
+		memcpy(fData + tail, data, first);
+		memcpy(fData, data + first, size - first);
+		fSize += size;
+	}
+
+	size_t EmscriptenRingBuffer::Read(U8* dst, size_t size)
+	{
+		size_t n = std::min(size, fSize);
+		size_t first = std::min(n, fCapacity - fHead);
+		memcpy(dst, fData + fHead, first);
+		memcpy(dst + first, fData, n - first);
+		fHead = (fHead + n) & (fCapacity - 1);
+		fSize -= n;
+		return n;
+	}
+
+	int EmscriptenRingBuffer::Find(U8 c) const
+	{
+		size_t first = std::min(fSize, fCapacity - fHead);
+		const U8* p = (const U8*) memchr(fData + fHead, c, first);
+		if (p)
+		{
+			return (int) (p - (fData + fHead));
+		}
+
+		p = (const U8*) memchr(fData, c, fSize - first);
+		if (p)
+		{
+			return (int) (first + (p - fData));
+		}
+		return -1;
+	}
+
+	//
+	// EmscriptenSocket
+	//
+
+	std::string EmscriptenSocket::sProxyURL;
+	const size_t EmscriptenSocket::kSendBufferSize;
+
+	EmscriptenSocket::EmscriptenSocket()
+		: fID(0)
+		, fState(kClosed)
+		, fInput(4096)
+		, fOutput(64)
+		, fPort(0)
+		, fBytesSent(0)
+		, fBytesReceived(0)
+	{
+	}
+
+	EmscriptenSocket::~EmscriptenSocket()
+	{
+		if (fID > 0)
+		{
+			jsSocketClose(fID);
+		}
+	}
+
+	void EmscriptenSocket::OnEvent(Event e)
+	{
+		switch (e)
+		{
+			case kOnOpen:
+			{
+				fState = kConnected;
+
+				// flush data sent while connecting
+				size_t size = fOutput.Size();
+				if (size > 0)
+				{
+					U8* buf = (U8*) malloc(size);
+					fOutput.Read(buf, size);
+					jsSocketSend(fID, buf, (int) size);
+					free(buf);
+				}
+				break;
+			}
+			case kOnError:
+				fError = (fState == kConnecting) ? "connection refused" : "closed";
+				break;
+			case kOnClose:
+				if (fState == kConnecting && fError.empty())
+				{
+					fError = "connection refused";
+				}
+				fState = kClosed;
+				break;
+			default:
+				break;
+		}
+	}
+
+	void EmscriptenSocket::OnData(const U8* data, int size)
+	{
+		fInput.Write(data, size);
+		fBytesReceived += size;
+	}
+
+	size_t EmscriptenSocket::Buffered() const
+	{
+		return (fState == kConnected) ? (size_t) jsSocketBufferedAmount(fID) : fOutput.Size();
+	}
+
+	// closed by the peer or failed to connect, receive() reports it
+	bool EmscriptenSocket::IsReadable() const
+	{
+		return fInput.Size() > 0 || (fState == kClosed && fID > 0);
+	}
+
+	bool EmscriptenSocket::IsWritable() const
+	{
+		return fState == kConnected && Buffered() < kSendBufferSize;
+	}
+
+	// Returns NULL if the value at index is not a live EmscriptenSocket
+	EmscriptenSocket* EmscriptenSocket::ToSocket(lua_State *L, int index)
+	{
+		EmscriptenSocket** ud = (EmscriptenSocket**) lua_touserdata(L, index);
+		if (ud && lua_getmetatable(L, index))
+		{
+			luaL_getmetatable(L, kSocketMetatable);
+			bool isSocket = lua_rawequal(L, -1, -2) != 0;
+			lua_pop(L, 2);
+			if (isSocket)
+			{
+				return *ud;
+			}
+		}
+		return NULL;
+	}
+
+	EmscriptenSocket* EmscriptenSocket::CheckSocket(lua_State *L, int index)
+	{
+		EmscriptenSocket** ud = (EmscriptenSocket**) luaL_checkudata(L, index, kSocketMetatable);
+		if (*ud == NULL)
+		{
+			// reached from another finalizer after this socket's __gc
+			luaL_error(L, "attempt to use a closed socket");
+		}
+		return *ud;
+	}
+
+	// socket.tcp()
+	int EmscriptenSocket::Create(lua_State *L)
+	{
+		EmscriptenSocket** ud = (EmscriptenSocket**) lua_newuserdata(L, sizeof(EmscriptenSocket*));
+		*ud = new EmscriptenSocket();
+		luaL_getmetatable(L, kSocketMetatable);
+		lua_setmetatable(L, -2);
+		return 1;
+	}
+
+	// socket.connect(host, port)
+	int EmscriptenSocket::ConnectSocket(lua_State *L)
+	{
+		Create(L);
+		lua_insert(L, 1);
+		int n = Connect(L);
+
+		// a connection in progress is not an error, the data sent meanwhile is queued
+		if (n == 2 && lua_isnil(L, -2) && strcmp(lua_tostring(L, -1), "timeout") == 0)
+		{
+			lua_pushvalue(L, 1);
+			return 1;
+		}
+		return n;
+	}
+
+	// socket.setProxy(url), '{host}' and '{port}' in url are replaced with the connect() arguments
+	int EmscriptenSocket::SetProxy(lua_State *L)
+	{
+		sProxyURL = luaL_optstring(L, 1, "");
+		return 0;
+	}
+
+	// tcp:connect(host, port)
+	int EmscriptenSocket::Connect(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		const char* host = luaL_checkstring(L, 2);
+		int port = luaL_checkinteger(L, 3);
+
+		switch (thiz->fState)
+		{
+			case kConnected:
+				lua_pushinteger(L, 1);
+				return 1;
+
+			case kConnecting:
+				lua_pushnil(L);
+				lua_pushstring(L, "timeout");
+				return 2;
+
+			case kClosed:
+			default:
+				if (thiz->fID > 0 && !thiz->fError.empty())
+				{
+					// previous attempt has failed
+					lua_pushnil(L);
+					lua_pushstring(L, thiz->fError.c_str());
+					jsSocketClose(thiz->fID);
+					thiz->fID = 0;
+					thiz->fError.clear();
+					return 2;
+				}
+				break;
+		}
+
+		if (thiz->fID > 0)
+		{
+			// reconnect of a socket closed by the peer
+			jsSocketClose(thiz->fID);
+		}
+
+		thiz->fHost = host;
+		thiz->fPort = port;
+		thiz->fInput.Clear();
+		thiz->fID = jsSocketConnect(sProxyURL.c_str(), host, port, thiz);
+		if (thiz->fID <= 0)
+		{
+			lua_pushnil(L);
+			lua_pushstring(L, "connection refused");
+			return 2;
+		}
+
+		thiz->fState = kConnecting;
+		lua_pushnil(L);
+		lua_pushstring(L, "timeout");
+		return 2;
+	}
+
+	// tcp:send(data [, i [, j]])
+	int EmscriptenSocket::Send(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		size_t size = 0;
+		const char* data = luaL_checklstring(L, 2, &size);
+		long start = (long) luaL_optnumber(L, 3, 1);
+		long end = (long) luaL_optnumber(L, 4, -1);
+
+		// LuaSocket string indices
+		if (start < 0) start = (long) size + start + 1;
+		if (start < 1) start = 1;
+		if (end < 0) end = (long) size + end + 1;
+		if (end > (long) size) end = (long) size;
+
+		if (thiz->fState == kClosed)
+		{
+			lua_pushnil(L);
+			lua_pushstring(L, "closed");
+			lua_pushinteger(L, start - 1);
+			return 3;
+		}
+
+		if (start <= end)
+		{
+			const U8* p = (const U8*) data + start - 1;
+			size_t n = end - start + 1;
+
+			// take only what fits in the send buffer, a partial send returns the index of the last byte sent
+			size_t buffered = thiz->Buffered();
+			size_t count = std::min(n, buffered < kSendBufferSize ? kSendBufferSize - buffered : 0);
+			if (count > 0)
+			{
+				if (thiz->fState == kConnected)
+				{
+					jsSocketSend(thiz->fID, p, (int) count);
+				}
+				else
+				{
+					thiz->fOutput.Write(p, count);
+				}
+				thiz->fBytesSent += count;
+			}
+
+			if (count < n)
+			{
+				lua_pushnil(L);
+				lua_pushstring(L, "timeout");
+				lua_pushinteger(L, start - 1 + (long) count);
+				return 3;
+			}
+		}
+
+		lua_pushinteger(L, end);
+		return 1;
+	}
+
+	// tcp:receive([pattern [, prefix]])
+	int EmscriptenSocket::Receive(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		size_t prefixSize = 0;
+		const char* prefix = luaL_optlstring(L, 3, "", &prefixSize);
+		EmscriptenRingBuffer& input = thiz->fInput;
+
+		// number of bytes to read, -1 if not enough data
+		int want = -1;
+		bool isLine = false;
+		if (lua_isnumber(L, 2))
+		{
+			size_t n = (size_t) lua_tointeger(L, 2);
+			want = (input.Size() >= n) ? (int) n : -1;
+		}
+		else
+		{
+			const char* pattern = luaL_optstring(L, 2, "*l");
+			if (strncmp(pattern, "*l", 2) == 0)
+			{
+				int eol = input.Find('\n');
+				want = (eol >= 0) ? eol + 1 : -1;
+				isLine = true;
+			}
+			else if (strncmp(pattern, "*a", 2) == 0)
+			{
+				want = (thiz->fState == kClosed) ? (int) input.Size() : -1;
+			}
+			else
+			{
+				return luaL_argerror(L, 2, "invalid receive pattern");
+			}
+		}
+
+		// partial result consumes whatever is buffered, as LuaSocket does
+		bool complete = want >= 0;
+		size_t size = complete ? (size_t) want : input.Size();
+
+		std::string result(prefix, prefixSize);
+		result.resize(prefixSize + size);
+		input.Read((U8*) &result[prefixSize], size);
+
+		if (isLine)
+		{
+			// drop '\n' and ignore all '\r'
+			if (complete)
+			{
+				result.resize(result.size() - 1);
+			}
+			result.erase(std::remove(result.begin() + prefixSize, result.end(), '\r'), result.end());
+		}
+
+		if (complete)
+		{
+			lua_pushlstring(L, result.data(), result.size());
+			return 1;
+		}
+
+		lua_pushnil(L);
+		lua_pushstring(L, thiz->fState == kClosed ? "closed" : "timeout");
+		lua_pushlstring(L, result.data(), result.size());
+		return 3;
+	}
+
+	// tcp:settimeout(value [, mode]), browser sockets can not block
+	int EmscriptenSocket::SetTimeout(lua_State *L)
+	{
+		CheckSocket(L, 1);
+		lua_pushinteger(L, 1);
+		return 1;
+	}
+
+	int EmscriptenSocket::Close(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		if (thiz->fID > 0)
+		{
+			jsSocketClose(thiz->fID);
+			thiz->fID = 0;
+		}
+		thiz->fState = kClosed;
+		thiz->fInput.Clear();
+		thiz->fOutput.Clear();
+		lua_pushinteger(L, 1);
+		return 1;
+	}
+
+	int EmscriptenSocket::Shutdown(lua_State *L)
+	{
+		return Close(L);
+	}
+
+	int EmscriptenSocket::GetPeerName(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		if (thiz->fState != kConnected)
+		{
+			lua_pushnil(L);
+			lua_pushstring(L, "closed");
+			return 2;
+		}
+		lua_pushstring(L, thiz->fHost.c_str());
+		lua_pushinteger(L, thiz->fPort);
+		return 2;
+	}
+
+	int EmscriptenSocket::GetSockName(lua_State *L)
+	{
+		CheckSocket(L, 1);
+		lua_pushstring(L, "0.0.0.0");
+		lua_pushinteger(L, 0);
+		return 2;
+	}
+
+	int EmscriptenSocket::GetStats(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		lua_pushnumber(L, (lua_Number) thiz->fBytesReceived);
+		lua_pushnumber(L, (lua_Number) thiz->fBytesSent);
+		lua_pushnumber(L, 0);
+		return 3;
+	}
+
+	// options like 'tcp-nodelay' have no meaning for a WebSocket
+	int EmscriptenSocket::SetOption(lua_State *L)
+	{
+		CheckSocket(L, 1);
+		lua_pushinteger(L, 1);
+		return 1;
+	}
+
+	int EmscriptenSocket::Dirty(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		lua_pushboolean(L, thiz->fInput.Size() > 0);
+		return 1;
+	}
+
+	// socket.select(recvt, sendt [, timeout]), never blocks.
+	// Only sockets of this library are checked, other values in the tables are ignored.
+	int EmscriptenSocket::Select(lua_State *L)
+	{
+		lua_settop(L, 2);
+		bool isReady = false;
+		for (int arg = 1; arg <= 2; arg++)
+		{
+			lua_newtable(L);
+			int result = lua_gettop(L);
+			if (!lua_istable(L, arg))
+			{
+				continue;
+			}
+
+			int count = 0;
+			for (int i = 1; ; i++)
+			{
+				lua_rawgeti(L, arg, i);
+				if (lua_isnil(L, -1))
+				{
+					lua_pop(L, 1);
+					break;
+				}
+
+				EmscriptenSocket* s = ToSocket(L, -1);
+				if (s && (arg == 1 ? s->IsReadable() : s->IsWritable()))
+				{
+					// LuaSocket fills both the array and the set part
+					lua_pushvalue(L, -1);
+					lua_rawseti(L, result, ++count);
+					lua_pushboolean(L, 1);
+					lua_rawset(L, result);
+					isReady = true;
+				}
+				else
+				{
+					lua_pop(L, 1);
+				}
+			}
+		}
+
+		if (isReady)
+		{
+			return 2;
+		}
+		lua_pushstring(L, "timeout");
+		return 3;
+	}
+
+	int EmscriptenSocket::ToString(lua_State *L)
+	{
+		EmscriptenSocket* thiz = CheckSocket(L, 1);
+		lua_pushfstring(L, "tcp{%s}: %p", thiz->fState == kClosed ? "master" : "client", thiz);
+		return 1;
+	}
+
+	int EmscriptenSocket::Finalizer(lua_State *L)
+	{
+		EmscriptenSocket** ud = (EmscriptenSocket**) luaL_checkudata(L, 1, kSocketMetatable);
+		delete *ud;
+		*ud = NULL;
+		return 0;
+	}
+
+	// Replaces tcp, connect and select of the LuaSocket table at index
+	void EmscriptenSocket::Install(lua_State *L, int index)
+	{
+		lua_pushcfunction(L, Create);
+		lua_setfield(L, index, "tcp");
+		lua_pushcfunction(L, ConnectSocket);
+		lua_setfield(L, index, "connect");
+		lua_pushcfunction(L, Select);
+		lua_setfield(L, index, "select");
+	}
+
+	// package.preload["socket"], upvalue is the loader it replaced
+	int EmscriptenSocket::PreloadSocket(lua_State *L)
+	{
+		int top = lua_gettop(L);
+		if (lua_isfunction(L, lua_upvalueindex(1)))
+		{
+			lua_pushvalue(L, lua_upvalueindex(1));
+			lua_insert(L, 1);
+			lua_call(L, top, 1);
+
+			// modules written with module() leave their table in package.loaded
+			if (!lua_istable(L, -1))
+			{
+				lua_pop(L, 1);
+				lua_getglobal(L, "package");
+				lua_getfield(L, -1, "loaded");
+				lua_getfield(L, -1, "socket");
+				lua_replace(L, -3);
+				lua_pop(L, 1);
+			}
+		}
+		else
+		{
+			// no LuaSocket in this build
+			lua_newtable(L);
+		}
+
+		if (lua_istable(L, -1))
+		{
+			Install(L, lua_gettop(L));
+		}
+		return 1;
+	}
+
+	// require("socket.websocket") returns the library and replaces socket.tcp, socket.connect and socket.select
+	// of LuaSocket, already loaded or required later, so existing code runs unchanged
+	int EmscriptenSocket::Open(lua_State *L)
+	{
+		const luaL_Reg kMethods[] =
+		{
+			{ "connect", Connect },
+			{ "send", Send },
+			{ "receive", Receive },
+			{ "settimeout", SetTimeout },
+			{ "close", Close },
+			{ "shutdown", Shutdown },
+			{ "getpeername", GetPeerName },
+			{ "getsockname", GetSockName },
+			{ "getstats", GetStats },
+			{ "setoption", SetOption },
+			{ "dirty", Dirty },
+			{ NULL, NULL }
+		};
+
+		const luaL_Reg kFunctions[] =
+		{
+			{ "tcp", Create },
+			{ "connect", ConnectSocket },
+			{ "setProxy", SetProxy },
+			{ "select", Select },
+			{ NULL, NULL }
+		};
+
+		luaL_newmetatable(L, kSocketMetatable);
+		lua_newtable(L);
+		luaL_register(L, NULL, kMethods);
+		lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, Finalizer);
+		lua_setfield(L, -2, "__gc");
+		lua_pushcfunction(L, ToString);
+		lua_setfield(L, -2, "__tostring");
+		lua_pop(L, 1);
+
+		lua_newtable(L);
+		luaL_register(L, NULL, kFunctions);
+
+		lua_getglobal(L, "package");
+		if (lua_istable(L, -1))
+		{
+			lua_getfield(L, -1, "loaded");
+			lua_getfield(L, -1, "socket");
+			if (lua_istable(L, -1))
+			{
+				Install(L, lua_gettop(L));
+			}
+			lua_pop(L, 2);
+
+			lua_getfield(L, -1, "preload");
+			if (lua_istable(L, -1))
+			{
+				lua_getfield(L, -1, "socket");
+				lua_pushcclosure(L, PreloadSocket, 1);
+				lua_setfield(L, -2, "socket");
+			}
+			lua_pop(L, 1);
+		}
+		lua_pop(L, 1);
+
+		return 1;
+	}
+
+}
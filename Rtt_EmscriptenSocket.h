@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Build.h"
+#include "Core/Rtt_Types.h"
+#include <string>
+
+struct lua_State;
+
+namespace Rtt
+{
+
+	// Byte FIFO with power of two capacity, grows when a write does not fit
+	class EmscriptenRingBuffer
+	{
+		public:
+			EmscriptenRingBuffer(size_t capacity);
+			~EmscriptenRingBuffer();
+
+			size_t Size() const { return fSize; }
+			void Write(const U8* data, size_t size);
+			size_t Read(U8* dst, size_t size);
+
+			// Returns offset of the first 'c' or -1
+			int Find(U8 c) const;
+			void Clear() { fHead = fSize = 0; }
+
+		private:
+			void Grow(size_t minCapacity);
+
+			U8* fData;
+			size_t fCapacity;
+			size_t fHead;
+			size_t fSize;
+	};
+
+	// LuaSocket compatible TCP client, transported by a WebSocket through a proxy.
+	// Always non-blocking: calls that would block return nil, "timeout" like LuaSocket does with settimeout(0).
+	// send() accepts at most kSendBufferSize bytes not yet handed to the network, the rest is left to the caller.
+	class EmscriptenSocket
+	{
+		public:
+			enum State
+			{
+				kClosed = 0,
+				kConnecting,
+				kConnected,
+			};
+
+			// JS ==> C events
+			enum Event
+			{
+				kOnOpen = 1,
+				kOnClose = 2,
+				kOnError = 3,
+			};
+
+			// limit of the data queued by send(), like the kernel buffer of a TCP socket
+			static const size_t kSendBufferSize = 256 * 1024;
+
+			EmscriptenSocket();
+			~EmscriptenSocket();
+
+			static int Open(lua_State *L);
+
+			void OnEvent(Event e);
+			void OnData(const U8* data, int size);
+
+		private:
+			static EmscriptenSocket* CheckSocket(lua_State *L, int index);
+			static EmscriptenSocket* ToSocket(lua_State *L, int index);
+			static void Install(lua_State *L, int index);
+			static int PreloadSocket(lua_State *L);
+			static int Select(lua_State *L);
+			static int Create(lua_State *L);
+			static int Connect(lua_State *L);
+			static int ConnectSocket(lua_State *L);
+			static int SetProxy(lua_State *L);
+			static int Send(lua_State *L);
+			static int Receive(lua_State *L);
+			static int SetTimeout(lua_State *L);
+			static int Close(lua_State *L);
+			static int Shutdown(lua_State *L);
+			static int GetPeerName(lua_State *L);
+			static int GetSockName(lua_State *L);
+			static int GetStats(lua_State *L);
+			static int SetOption(lua_State *L);
+			static int Dirty(lua_State *L);
+			static int ToString(lua_State *L);
+			static int Finalizer(lua_State *L);
+
+			size_t Buffered() const;
+			bool IsReadable() const;
+			bool IsWritable() const;
+
+			int fID;		// JS WebSocket ID
+			State fState;
+			EmscriptenRingBuffer fInput;
+			EmscriptenRingBuffer fOutput;		// data sent while connecting
+			std::string fHost;
+			int fPort;
+			size_t fBytesSent;
+			size_t fBytesReceived;
+			std::string fError;
+
+			static std::string sProxyURL;
+	};
+
+}
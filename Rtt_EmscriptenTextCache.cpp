@@ -0,0 +1,159 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenTextCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace Rtt
+{
+
+	// default budget of masks no text uses, a few hundred list rows
+	static const size_t kDefaultBudget = 4 * 1024 * 1024;
+
+	EmscriptenTextCache& EmscriptenTextCache::Instance()
+	{
+		static EmscriptenTextCache sCache;
+		return sCache;
+	}
+
+	EmscriptenTextCache::EmscriptenTextCache()
+		: fBudget(kDefaultBudget)
+		, fUnusedBytes(0)
+	{
+		memset(&fStats, 0, sizeof(fStats));
+	}
+
+	EmscriptenTextCache::~EmscriptenTextCache()
+	{
+		// texts still alive at exit do not release their masks
+		while (!fEntries.empty())
+		{
+			Remove(fEntries.begin());
+		}
+	}
+
+	std::string EmscriptenTextCache::MakeKey(const char* str, const char* fontName, float size, int width, int height, const char* alignment, bool isNative)
+	{
+		char style[64];
+		snprintf(style, sizeof(style), "%g|%d|%d|%d|", size, width, height, isNative ? 1 : 0);
+
+		std::string key(style);
+		key += alignment ? alignment : "";
+		key += '|';
+		key += fontName ? fontName : "";
+		key += '|';
+		key += str ? str : "";
+		return key;
+	}
+
+	const U8* EmscriptenTextCache::Acquire(const std::string& key, int& width, int& height)
+	{
+		if (fBudget == 0)
+		{
+			return NULL;
+		}
+
+		std::map<std::string, EntryList::iterator>::iterator it = fIndex.find(key);
+		if (it == fIndex.end())
+		{
+			fStats.fMisses++;
+			return NULL;
+		}
+
+		EntryList::iterator entry = it->second;
+		if (entry->fRefs++ == 0)
+		{
+			fUnusedBytes -= entry->fWidth * entry->fHeight;
+		}
+		width = entry->fWidth;
+		height = entry->fHeight;
+
+		// move to front
+		fEntries.splice(fEntries.begin(), fEntries, entry);
+		fStats.fHits++;
+		return entry->fData;
+	}
+
+	bool EmscriptenTextCache::Put(const std::string& key, U8* data, int width, int height)
+	{
+		size_t bytes = width * height;
+		if (data == NULL || bytes == 0 || fBudget == 0 || fIndex.find(key) != fIndex.end())
+		{
+			return false;
+		}
+
+		Entry e;
+		e.fKey = key;
+		e.fData = data;
+		e.fWidth = width;
+		e.fHeight = height;
+		e.fRefs = 1;
+
+		fEntries.push_front(e);
+		fIndex[e.fKey] = fEntries.begin();
+		fStats.fBytes += bytes;
+		fStats.fCount++;
+		return true;
+	}
+
+	void EmscriptenTextCache::Release(const std::string& key)
+	{
+		std::map<std::string, EntryList::iterator>::iterator it = fIndex.find(key);
+		if (it != fIndex.end() && it->second->fRefs > 0 && --it->second->fRefs == 0)
+		{
+			fUnusedBytes += it->second->fWidth * it->second->fHeight;
+			Evict();
+		}
+	}
+
+	// Drops least recently used masks no text uses until they fit in the budget
+	void EmscriptenTextCache::Evict()
+	{
+		EntryList::iterator it = fEntries.end();
+		while (it != fEntries.begin() && fUnusedBytes > fBudget)
+		{
+			--it;
+			if (it->fRefs == 0)
+			{
+				EntryList::iterator unused = it++;
+				Remove(unused);
+				fStats.fEvictions++;
+			}
+		}
+	}
+
+	void EmscriptenTextCache::Remove(EntryList::iterator it)
+	{
+		size_t bytes = it->fWidth * it->fHeight;
+		if (it->fRefs == 0)
+		{
+			fUnusedBytes -= bytes;
+		}
+		fStats.fBytes -= bytes;
+		fStats.fCount--;
+		free(it->fData);
+		fIndex.erase(it->fKey);
+		fEntries.erase(it);
+	}
+
+	void EmscriptenTextCache::SetBudget(size_t bytes)
+	{
+		fBudget = bytes;
+		Evict();
+	}
+
+	EmscriptenTextCache::Stats EmscriptenTextCache::GetStats() const
+	{
+		return fStats;
+	}
+
+}
@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+#include <string>
+#include <list>
+#include <map>
+
+namespace Rtt
+{
+
+	// Rendered text masks keyed by string, font, size, alignment and box size.
+	// Identical texts share one reference counted mask, e.g. captions repeated in table rows.
+	// Masks no text uses any more are kept for reuse and evicted least recently used first.
+	// Main thread only.
+	class EmscriptenTextCache
+	{
+	public:
+		struct Stats
+		{
+			U32 fHits;
+			U32 fMisses;
+			U32 fEvictions;
+			size_t fBytes;		// all masks, including those texts use
+			size_t fCount;
+		};
+
+		static EmscriptenTextCache& Instance();
+
+		EmscriptenTextCache();
+		~EmscriptenTextCache();
+
+		static std::string MakeKey(const char* str, const char* fontName, float size, int width, int height, const char* alignment, bool isNative);
+
+		// Returns the shared mask and adds a reference, NULL on a miss
+		const U8* Acquire(const std::string& key, int& width, int& height);
+
+		// Takes ownership of the malloc'ed mask with one reference, false if it is not cached
+		// and stays with the caller. A mask in use is cached whatever its size, the budget applies once it is released
+		bool Put(const std::string& key, U8* data, int width, int height);
+
+		// Drops a reference, the mask stays cached until it is evicted
+		void Release(const std::string& key);
+
+		// Bytes of masks no text uses, 0 disables the cache, masks in use are kept
+		void SetBudget(size_t bytes);
+		size_t GetBudget() const { return fBudget; }
+
+		Stats GetStats() const;
+
+	private:
+		struct Entry
+		{
+			std::string fKey;
+			U8* fData;
+			int fWidth;
+			int fHeight;
+			int fRefs;
+		};
+		typedef std::list<Entry> EntryList;
+
+		void Evict();
+		void Remove(EntryList::iterator it);
+
+		EntryList fEntries;		// most recently used first
+		std::map<std::string, EntryList::iterator> fIndex;
+		size_t fBudget;
+		size_t fUnusedBytes;		// masks with no reference, what the budget limits
+		Stats fStats;
+	};
+
+}
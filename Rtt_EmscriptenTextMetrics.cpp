@@ -0,0 +1,155 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenTextMetrics.h"
+#include "Rtt_EmscriptenGlyphAtlas.h"
+#include "Rtt_Lua.h"
+#include <stdio.h>
+#include <string>
+#include <map>
+
+#if defined(EMSCRIPTEN)
+extern "C"
+{
+	extern void jsFontMetrics(const char* fontName, int fontSize, float* metrics);
+	extern void jsMeasureText(const char* text, const char* fontName, int fontSize, int width, float* size);
+}
+#else
+extern "C"
+{
+	void jsFontMetrics(const char* fontName, int fontSize, float* metrics)
+	{
+		metrics[0] = fontSize * 0.8f;
+		metrics[1] = -fontSize * 0.2f;
+		metrics[2] = (float) fontSize;
+	}
+	void jsMeasureText(const char* text, const char* fontName, int fontSize, int width, float* size)
+	{
+		size[0] = (float) width;
+		size[1] = (float) fontSize;
+	}
+}
+#endif
+
+namespace Rtt
+{
+
+	EmscriptenTextMetrics::Metrics EmscriptenTextMetrics::GetMetrics(const char* fontName, float size)
+	{
+		static std::map<std::string, Metrics> sCache;
+
+		EmscriptenGlyphAtlas& atlas = EmscriptenGlyphAtlas::Instance();
+		bool isNative = atlas.IsEnabled();
+
+		// text sizes are whole pixels, rounded the way both backends round them
+		int fontSize = EmscriptenGlyphAtlas::PixelSize(size);
+		char style[32];
+		snprintf(style, sizeof(style), "%d|%d|", fontSize, isNative ? 1 : 0);
+		std::string key = style;
+		key += fontName ? fontName : "";
+
+		std::map<std::string, Metrics>::const_iterator it = sCache.find(key);
+		if (it != sCache.end())
+		{
+			return it->second;
+		}
+
+		Metrics m;
+		int ascent, descent, height, lineSkip;
+		if (isNative && atlas.GetFontMetrics(fontName, size, ascent, descent, height, lineSkip))
+		{
+			m.fAscent = (float) ascent;
+			m.fDescent = (float) descent;
+			m.fHeight = (float) height;
+			m.fLeading = (float) (lineSkip - height);
+		}
+		else
+		{
+			float js[3];
+			jsFontMetrics(fontName ? fontName : "", fontSize, js);
+			m.fAscent = js[0];
+			m.fDescent = js[1];
+			m.fHeight = js[0] - js[1];
+			m.fLeading = js[2] > m.fHeight ? js[2] - m.fHeight : 0;
+		}
+
+		sCache[key] = m;
+		return m;
+	}
+
+	void EmscriptenTextMetrics::Measure(const char* str, const char* fontName, float size, int width, float& outWidth, float& outHeight)
+	{
+		int w = 0;
+		int h = 0;
+		if (EmscriptenGlyphAtlas::Instance().Measure(str, fontName, size, width, w, h))
+		{
+			outWidth = (float) (width > 0 ? width : w);
+			outHeight = (float) h;
+			return;
+		}
+
+		float js[2];
+		jsMeasureText(str ? str : "", fontName ? fontName : "", EmscriptenGlyphAtlas::PixelSize(size), width, js);
+		outWidth = js[0];
+		outHeight = js[1];
+	}
+
+	// font file name or family, native.systemFont and nil are the default font
+	const char* EmscriptenTextMetrics::ToFontName(lua_State *L, int index)
+	{
+		return (lua_type(L, index) == LUA_TSTRING) ? lua_tostring(L, index) : "";
+	}
+
+	// textMetrics.measure(text, font, size [, width]) returns width, height
+	int EmscriptenTextMetrics::LuaMeasure(lua_State *L)
+	{
+		const char* str = luaL_checkstring(L, 1);
+		const char* fontName = ToFontName(L, 2);
+		float size = (float) luaL_checknumber(L, 3);
+		int width = (int) luaL_optnumber(L, 4, 0);
+
+		float w, h;
+		Measure(str, fontName, size, width, w, h);
+		lua_pushnumber(L, w);
+		lua_pushnumber(L, h);
+		return 2;
+	}
+
+	// textMetrics.getMetrics(font, size) returns { ascent, descent, leading, height }
+	int EmscriptenTextMetrics::LuaGetMetrics(lua_State *L)
+	{
+		Metrics m = GetMetrics(ToFontName(L, 1), (float) luaL_checknumber(L, 2));
+		lua_createtable(L, 0, 4);
+		lua_pushnumber(L, m.fAscent);
+		lua_setfield(L, -2, "ascent");
+		lua_pushnumber(L, m.fDescent);
+		lua_setfield(L, -2, "descent");
+		lua_pushnumber(L, m.fLeading);
+		lua_setfield(L, -2, "leading");
+		lua_pushnumber(L, m.fHeight);
+		lua_setfield(L, -2, "height");
+		return 1;
+	}
+
+	int EmscriptenTextMetrics::Open(lua_State *L)
+	{
+		const luaL_Reg kFunctions[] =
+		{
+			{ "measure", LuaMeasure },
+			{ "getMetrics", LuaGetMetrics },
+			{ NULL, NULL }
+		};
+
+		lua_newtable(L);
+		luaL_register(L, NULL, kFunctions);
+		return 1;
+	}
+
+}
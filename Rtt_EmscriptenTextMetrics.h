@@ -0,0 +1,46 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Core/Rtt_Types.h"
+
+struct lua_State;
+
+namespace Rtt
+{
+
+	// Font metrics and text measuring without rasterizing, require("textMetrics").
+	// Metrics come from the glyph atlas font tables when the native text renderer has the font,
+	// from the browser canvas otherwise, and are cached per font and size.
+	class EmscriptenTextMetrics
+	{
+		public:
+			struct Metrics
+			{
+				float fAscent;
+				float fDescent;		// negative, below the baseline
+				float fLeading;
+				float fHeight;
+			};
+
+			static Metrics GetMetrics(const char* fontName, float size);
+
+			// Size of str as a text object with the given wrap width would have, 0 does not wrap
+			static void Measure(const char* str, const char* fontName, float size, int width, float& outWidth, float& outHeight);
+
+			static int Open(lua_State *L);
+
+		private:
+			static const char* ToFontName(lua_State *L, int index);
+			static int LuaMeasure(lua_State *L);
+			static int LuaGetMetrics(lua_State *L);
+	};
+
+}
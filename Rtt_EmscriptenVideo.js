@@ -64,31 +64,26 @@ var videoLibrary =
 					btn.style.width = btn.w + 'px';
 					btn.style.height = btn.h + 'px';
 					btn.style.backgroundColor = "yellow";
+					// capture canvas, reused for every frame, readback is faster from a CPU backed canvas
+					var mycanvas = document.createElement('canvas');
+					var ctx = mycanvas.getContext('2d', { willReadFrequently: true });
 					btn.onclick = function () {
 						// capture frame
-						var mycanvas = document.createElement('canvas');
-						mycanvas.height = video.videoHeight;
-						mycanvas.width = video.videoWidth;
-						var ctx = mycanvas.getContext('2d');
+						if (mycanvas.width != video.videoWidth || mycanvas.height != video.videoHeight) {
+							mycanvas.width = video.videoWidth;
+							mycanvas.height = video.videoHeight;
+						}
 						ctx.drawImage(video, 0, 0, mycanvas.width, mycanvas.height);
 
-						// get rgba
+						// get rgba, written once into the heap, the bitmap takes ownership of the buffer
 						var img = ctx.getImageData(0, 0, mycanvas.width, mycanvas.height);
 						if (img && img.width > 0 && img.height > 0) {
-							var size = img.width * img.height * 4;
-
-							var body = new Uint8Array(img.data);
-							body_buffer = Module._malloc(body.length);
-							body_length = body.length;
-							Module.writeArrayToMemory(body, body_buffer);
-
-							//console.log('captue', img, body);
-							_jsVideoRecorderCallback(thiz, 5, img.width, img.height, body_buffer);			// onDataAvailable
-
-							Module._free(body_buffer);
+							var buf = Module._malloc(img.data.length);
+							if (buf) {
+								HEAPU8.set(img.data, buf);
+								_jsVideoRecorderCallback(thiz, 5, img.width, img.height, buf);			// onDataAvailable
+							}
 						}
-
-						mycanvas.remove();
 					};
 					mediaRecorder.btn = btn;		// save
 
@@ -192,8 +192,12 @@ namespace Rtt
 		Mix_Chunk* chunk = Mix_LoadWAV(file_path);
 		if (chunk)
 		{
-			fSounds.push_back(new sdlSound(chunk));
-			return fSounds.size() - 1;
+			int id = fSounds.insert(new sdlSound(chunk));
+			if (id < 0)
+			{
+				Rtt_LogException("SDL_Mixer: too many sounds loaded\n");
+			}
+			return id;
 		}
 		else
 		{
@@ -226,9 +230,9 @@ namespace Rtt
 
 	void PlatformSDLAudioPlayer::FreeData(int id)
 	{
-		if (id >= 0 && id < fSounds.size())
+		if (!fSounds.remove(id))
 		{
-			fSounds.remove(id);
+			Rtt_LogException("SDL_Mixer: audio.dispose() with a stale or invalid handle %d\n", id);
 		}
 	}
 
@@ -252,15 +256,16 @@ namespace Rtt
 			return -1;
 		}
 
-		if (sndID >= 0 && sndID < fSounds.size() && fSounds[sndID] != NULL)
+		smart_ptr<sdlSound>* snd = fSounds.get(sndID);
+		if (snd && *snd != NULL)
 		{
 			sdlChannel* ch = fChannels[channel];
-			ch->fSound = fSounds[sndID];
+			ch->fSound = *snd;
 			ch->fTicks = ticks;
 			ch->fLoops = loops;
 			ch->fCallback = callback;
 			Mix_ChannelFinished(chunkFinished);
-			Mix_PlayChannelTimed(channel, fSounds[sndID]->fChunk, loops, ticks);
+			Mix_PlayChannelTimed(channel, (*snd)->fChunk, loops, ticks);
 			Mix_Volume(channel, ch->fVolume * fMasterVolume * 128);
 
 			return channel;
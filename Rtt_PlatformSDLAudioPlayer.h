@@ -196,7 +196,7 @@ namespace Rtt
 
 		static const unsigned int kSDLPlayerMaxNumberOfSources = 32;
 		array< smart_ptr<sdlChannel> > fChannels;		// playing sounds
-		array< smart_ptr<sdlSound> > fSounds;		// loaded sounds
+		slot_map< smart_ptr<sdlSound> > fSounds;		// loaded sounds, indexed by stable handles
 		float fMasterVolume;
 		int fReservedChannels;
 		bool fIsSuspended;
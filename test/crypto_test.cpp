@@ -0,0 +1,280 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// EmscriptenCrypto against the known answers of RFC 1320 (MD4), RFC 1321 (MD5), FIPS 180-4 (SHA) and RFC 4231 (HMAC),
+// then the throughput of every digest. Run with an argument to set the benchmark size in MB, 0 skips it.
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenCrypto.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace Rtt;
+
+static int sFailures = 0;
+
+static const char* kNames[] = { "MD4", "MD5", "SHA-1", "SHA-224", "SHA-256", "SHA-384", "SHA-512" };
+
+static std::string Hex(const U8* bytes, size_t length)
+{
+	static const char kDigits[] = "0123456789abcdef";
+	std::string result;
+	for (size_t i = 0; i < length; i++)
+	{
+		result += kDigits[bytes[i] >> 4];
+		result += kDigits[bytes[i] & 15];
+	}
+	return result;
+}
+
+static std::string Digest(MCrypto::Algorithm algorithm, const std::string& message)
+{
+	EmscriptenCrypto crypto;
+	U8 digest[64];
+	Data<const char> data(message.data(), message.size());
+	crypto.CalculateDigest(algorithm, data, digest);
+	return Hex(digest, crypto.GetDigestLength(algorithm));
+}
+
+static std::string HMAC(MCrypto::Algorithm algorithm, const std::string& key, const std::string& message)
+{
+	EmscriptenCrypto crypto;
+	U8 mac[64];
+	Data<const char> keyData(key.data(), key.size());
+	Data<const char> data(message.data(), message.size());
+	crypto.CalculateHMAC(algorithm, keyData, data, mac);
+	return Hex(mac, crypto.GetDigestLength(algorithm));
+}
+
+static void Check(const char* name, const char* what, size_t length, const std::string& actual, const char* expected)
+{
+	if (actual.compare(0, strlen(expected), expected) != 0)
+	{
+		fprintf(stderr, "%s %s of %d bytes is %s, expected %s\n", name, what, (int) length, actual.c_str(), expected);
+		sFailures++;
+	}
+}
+
+#define CHECK_DIGEST(algorithm, message, expected) Check(kNames[MCrypto::algorithm], "digest", (message).size(), Digest(MCrypto::algorithm, message), expected)
+#define CHECK_HMAC(algorithm, key, message, expected) Check(kNames[MCrypto::algorithm], "HMAC", (message).size(), HMAC(MCrypto::algorithm, key, message), expected)
+
+static const std::string kAlphabet = "abcdefghijklmnopqrstuvwxyz";
+static const std::string kAlphanumeric = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+static const std::string kDigits = "12345678901234567890123456789012345678901234567890123456789012345678901234567890";
+static const std::string kTwoBlocks256 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+static const std::string kTwoBlocks512 = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+static const std::string kMillion(1000000, 'a');
+
+static void TestMD()
+{
+	// RFC 1320 A.5
+	CHECK_DIGEST(kMD4Algorithm, std::string(""), "31d6cfe0d16ae931b73c59d7e0c089c0");
+	CHECK_DIGEST(kMD4Algorithm, std::string("a"), "bde52cb31de33e46245e05fbdbd6fb24");
+	CHECK_DIGEST(kMD4Algorithm, std::string("abc"), "a448017aaf21d8525fc10ae87aa6729d");
+	CHECK_DIGEST(kMD4Algorithm, std::string("message digest"), "d9130a8164549fe818874806e1c7014b");
+	CHECK_DIGEST(kMD4Algorithm, kAlphabet, "d79e1c308aa5bbcdeea8ed63df412da9");
+	CHECK_DIGEST(kMD4Algorithm, kAlphanumeric, "043f8582f241db351ce627e153e7f0e4");
+	CHECK_DIGEST(kMD4Algorithm, kDigits, "e33b4ddc9c38f2199c3e7b164fcc0536");
+
+	// RFC 1321 A.5
+	CHECK_DIGEST(kMD5Algorithm, std::string(""), "d41d8cd98f00b204e9800998ecf8427e");
+	CHECK_DIGEST(kMD5Algorithm, std::string("a"), "0cc175b9c0f1b6a831c399e269772661");
+	CHECK_DIGEST(kMD5Algorithm, std::string("abc"), "900150983cd24fb0d6963f7d28e17f72");
+	CHECK_DIGEST(kMD5Algorithm, std::string("message digest"), "f96b697d7cb7938d525a2f31aaf161d0");
+	CHECK_DIGEST(kMD5Algorithm, kAlphabet, "c3fcd3d76192e4007dfb496cca67e13b");
+	CHECK_DIGEST(kMD5Algorithm, kAlphanumeric, "d174ab98d277d9f5a5611c2c9f419d9f");
+	CHECK_DIGEST(kMD5Algorithm, kDigits, "57edf4a22be3c955ac49da2e2107b67a");
+}
+
+static void TestSHA()
+{
+	// FIPS 180-4 examples: one block, two blocks, one million "a"
+	CHECK_DIGEST(kSHA1Algorithm, std::string(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+	CHECK_DIGEST(kSHA1Algorithm, std::string("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+	CHECK_DIGEST(kSHA1Algorithm, kTwoBlocks256, "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+	CHECK_DIGEST(kSHA1Algorithm, kMillion, "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+	CHECK_DIGEST(kSHA224Algorithm, std::string(""), "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f");
+	CHECK_DIGEST(kSHA224Algorithm, std::string("abc"), "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7");
+	CHECK_DIGEST(kSHA224Algorithm, kTwoBlocks256, "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525");
+	CHECK_DIGEST(kSHA224Algorithm, kMillion, "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67");
+
+	CHECK_DIGEST(kSHA256Algorithm, std::string(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	CHECK_DIGEST(kSHA256Algorithm, std::string("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+	CHECK_DIGEST(kSHA256Algorithm, kTwoBlocks256, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+	CHECK_DIGEST(kSHA256Algorithm, kMillion, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+	CHECK_DIGEST(kSHA384Algorithm, std::string(""), "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b");
+	CHECK_DIGEST(kSHA384Algorithm, std::string("abc"), "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7");
+	CHECK_DIGEST(kSHA384Algorithm, kTwoBlocks512, "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039");
+	CHECK_DIGEST(kSHA384Algorithm, kMillion, "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b07b8b3dc38ecc4ebae97ddd87f3d8985");
+
+	CHECK_DIGEST(kSHA512Algorithm, std::string(""), "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e");
+	CHECK_DIGEST(kSHA512Algorithm, std::string("abc"), "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+	CHECK_DIGEST(kSHA512Algorithm, kTwoBlocks512, "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909");
+	CHECK_DIGEST(kSHA512Algorithm, kMillion, "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b");
+}
+
+// Every length up to 300 bytes crosses the padding boundaries of both block sizes (55/56/64 and 111/112/128).
+// The digests of byte i == i & 255 for each length are concatenated and checked as one SHA-256.
+static void TestLengths()
+{
+	static const char* kExpected[] =
+	{
+		"0a252a0fecbe56926d61b9e2c0a8364908f2f1126619b128b86f615c26e49baa",
+		"3124ad933e418748dd0cbc00d03f37976ad21b9e5c133dae798acd4ae0985ce2",
+		"b3b0918c06856119a009bebe37107fada5f9be1d72c2cc063d8244b0c07040c1",
+		"2f1a043aa49ebc58ce61d00d9e960c5c3b8cb1bd1c6b9a5a7383f6cf72696922",
+		"df90175783c44235cf6aefd935a2c2747f42399416d16789ece339f1fd26d835",
+		"5bf6a85e5c5716b52d16c15fc749f9aa226f5a74bb5503dd97cb6b3753244b3d",
+		"4f69b074b32dd7601715ace64b3ba867055aa49ac9e8e7f4f23713449989b2fa",
+	};
+
+	for (int algorithm = MCrypto::kMD4Algorithm; algorithm <= MCrypto::kSHA512Algorithm; algorithm++)
+	{
+		EmscriptenCrypto crypto;
+		std::string message, digests;
+		for (size_t length = 0; length < 300; length++)
+		{
+			U8 digest[64];
+			Data<const char> data(message.data(), message.size());
+			crypto.CalculateDigest((MCrypto::Algorithm) algorithm, data, digest);
+			digests.append((const char*) digest, crypto.GetDigestLength((MCrypto::Algorithm) algorithm));
+			message += (char) (length & 255);
+		}
+		Check(kNames[algorithm], "SHA-256 of the digests of lengths 0-299", digests.size(), Digest(MCrypto::kSHA256Algorithm, digests), kExpected[algorithm]);
+	}
+}
+
+static void TestHMAC()
+{
+	// RFC 4231 test cases 1-7, case 5 is truncated to 128 bits
+	struct TestCase
+	{
+		std::string key;
+		std::string data;
+		const char* expected[4];
+	};
+
+	const TestCase kCases[] =
+	{
+		{
+			std::string(20, '\x0b'), "Hi There",
+			{
+				"896fb1128abbdf196832107cd49df33f47b4b1169912ba4f53684b22",
+				"b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+				"afd03944d84895626b0825f4ab46907f15f9dadbe4101ec682aa034c7cebc59cfaea9ea9076ede7f4af152e8b2fa9cb6",
+				"87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cdedaa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854",
+			},
+		},
+		{
+			"Jefe", "what do ya want for nothing?",
+			{
+				"a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44",
+				"5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+				"af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e8e2240ca5e69e2c78b3239ecfab21649",
+				"164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737",
+			},
+		},
+		{
+			std::string(20, '\xaa'), std::string(50, '\xdd'),
+			{
+				"7fb3cb3588c6c1f6ffa9694d7d6ad2649365b0c1f65d69d1ec8333ea",
+				"773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+				"88062608d3e6ad8a0aa2ace014c8a86f0aa635d947ac9febe83ef4e55966144b2a5ab39dc13814b94e3ab6e101a34f27",
+				"fa73b0089d56a284efb0f0756c890be9b1b5dbdd8ee81a3655f83e33b2279d39bf3e848279a722c806b485a47e67c807b946a337bee8942674278859e13292fb",
+			},
+		},
+		{
+			"\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19", std::string(50, '\xcd'),
+			{
+				"6c11506874013cac6a2abc1bb382627cec6a90d86efc012de7afec5a",
+				"82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+				"3e8a69b7783c25851933ab6290af6ca77a9981480850009cc5577c6e1f573b4e6801dd23c4a7d679ccf8a386c674cffb",
+				"b0ba465637458c6990e5a8c5f61d4af7e576d97ff94b872de76f8050361ee3dba91ca5c11aa25eb4d679275cc5788063a5f19741120c4f2de2adebeb10a298dd",
+			},
+		},
+		{
+			std::string(20, '\x0c'), "Test With Truncation",
+			{
+				"0e2aea68a90c8d37c988bcdb9fca6fa8",
+				"a3b6167473100ee06e0c796c2955552b",
+				"3abf34c3503b2a23a46efc619baef897",
+				"415fad6271580a531d4179bc891d87a6",
+			},
+		},
+		{
+			std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First",
+			{
+				"95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e",
+				"60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+				"4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c60c2ef6ab4030fe8296248df163f44952",
+				"80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598",
+			},
+		},
+		{
+			std::string(131, '\xaa'), "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm.",
+			{
+				"3a854166ac5d9f023f54d517d0b39dbd946770db9c2b95c9f6f565d1",
+				"9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2",
+				"6617178e941f020d351e2f254e8fd32c602420feb0b8fb9adccebb82461e99c5a678cc31e799176d3860e6110c46523e",
+				"e37b6a775dc87dbaa4dfa9f96e5e3ffddebd71f8867289865df5a32d20cdc944b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58",
+			},
+		},
+	};
+
+	for (size_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++)
+	{
+		CHECK_HMAC(kSHA224Algorithm, kCases[i].key, kCases[i].data, kCases[i].expected[0]);
+		CHECK_HMAC(kSHA256Algorithm, kCases[i].key, kCases[i].data, kCases[i].expected[1]);
+		CHECK_HMAC(kSHA384Algorithm, kCases[i].key, kCases[i].data, kCases[i].expected[2]);
+		CHECK_HMAC(kSHA512Algorithm, kCases[i].key, kCases[i].data, kCases[i].expected[3]);
+	}
+}
+
+static void Benchmark(size_t megabytes)
+{
+	std::vector<char> buffer(megabytes << 20);
+	for (size_t i = 0; i < buffer.size(); i++)
+	{
+		buffer[i] = (char) (i * 7);
+	}
+
+	EmscriptenCrypto crypto;
+	Data<const char> data(&buffer[0], buffer.size());
+	for (int algorithm = MCrypto::kMD4Algorithm; algorithm <= MCrypto::kSHA512Algorithm; algorithm++)
+	{
+		U8 digest[64];
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		crypto.CalculateDigest((MCrypto::Algorithm) algorithm, data, digest);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("crypto_test: %-8s %8.1f MB/s\n", kNames[algorithm], megabytes / seconds);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	TestMD();
+	TestSHA();
+	TestLengths();
+	TestHMAC();
+
+	size_t megabytes = argc > 1 ? (size_t) atoi(argv[1]) : 64;
+	if (megabytes > 0 && sFailures == 0)
+	{
+		Benchmark(megabytes);
+	}
+
+	printf("crypto_test: %s\n", sFailures ? "FAILED" : "passed");
+	return sFailures ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// EmscriptenDecodeQueue with worker threads. The decoder is replaced by a fake one which blocks workers
+// on a gate, so the main thread can call Take() while a worker is still decoding the same file.
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenDecodeQueue.h"
+#include "Rtt_EmscriptenImageDecoder.h"
+#include "Rtt_EmscriptenPixels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Rtt;
+
+static std::thread::id sMainThread;
+static std::mutex sGateMutex;
+static std::condition_variable sGateChanged;
+static bool sGateOpen = true;
+static std::atomic<int> sStarted(0);
+static std::atomic<int> sFinished(0);
+static int sFailures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); sFailures++; } } while (0)
+
+static void SetGate(bool open)
+{
+	{
+		std::lock_guard<std::mutex> lock(sGateMutex);
+		sGateOpen = open;
+	}
+	sGateChanged.notify_all();
+}
+
+// Polls cond for up to 5 seconds
+template <typename T>
+static bool WaitFor(T cond)
+{
+	for (int i = 0; i < 5000 && !cond(); i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return cond();
+}
+
+//
+// Fake decoder, 4x4 pixels filled with the length of the path
+//
+
+namespace Rtt
+{
+	U8* EmscriptenImageDecoder::DecodeFile(const char* path, int& width, int& height, float& scale, int maxSize, bool premultiply)
+	{
+		sStarted++;
+		if (std::this_thread::get_id() != sMainThread)
+		{
+			std::unique_lock<std::mutex> lock(sGateMutex);
+			while (!sGateOpen)
+			{
+				sGateChanged.wait(lock);
+			}
+		}
+
+		width = height = 4;
+		scale = 1;
+		U8* data = (U8*) malloc(width * height * 4);
+		memset(data, (int) strlen(path), width * height * 4);
+		sFinished++;
+		return data;
+	}
+
+	U8* EmscriptenImageDecoder::Downscale(U8* pixels, int& width, int& height, float& scale, int maxSize)
+	{
+		return pixels;
+	}
+
+	int EmscriptenImageDecoder::GetMaxSize(bool isFullResolution)
+	{
+		return 4096;
+	}
+
+	void EmscriptenPixels::Premultiply(U8* dst, const U8* src, size_t count)
+	{
+	}
+}
+
+// the tests pass no listeners
+CoronaLuaRef CoronaLuaNewRef(lua_State *L, int index) { return NULL; }
+void CoronaLuaDeleteRef(lua_State *L, CoronaLuaRef ref) {}
+void CoronaLuaNewEvent(lua_State *L, const char *eventName) {}
+void CoronaLuaDispatchEvent(lua_State *L, CoronaLuaRef listener, int nresults) {}
+
+static std::vector<std::string> Paths(const char* prefix, int count)
+{
+	std::vector<std::string> paths;
+	for (int i = 0; i < count; i++)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "%s%d.png", prefix, i);
+		paths.push_back(name);
+	}
+	return paths;
+}
+
+// Take() of a file a worker is decoding returns at once, the worker's result is freed when it finishes
+static void TestTakeDoesNotWait(EmscriptenDecodeQueue& queue)
+{
+	SetGate(false);
+	sStarted = sFinished = 0;
+	queue.Prefetch(NULL, Paths("busy", 1), 0);
+	CHECK(WaitFor([] { return sStarted == 1; }));
+
+	int width = 0, height = 0;
+	float scale = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	U8* data = queue.Take("busy0.png", width, height, scale);
+	CHECK(data == NULL);
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+
+	// the caller decodes it
+	data = queue.Load("busy0.png", width, height, scale);
+	CHECK(data != NULL && width == 4 && height == 4);
+	free(data);
+
+	SetGate(true);
+	CHECK(WaitFor([] { return sFinished == 2; }));
+}
+
+static void TestTakePrefetched(EmscriptenDecodeQueue& queue)
+{
+	std::vector<std::string> paths = Paths("ready", 8);
+	sStarted = sFinished = 0;
+	queue.Prefetch(NULL, paths, 0);
+	CHECK(WaitFor([] { return sFinished == 8; }));
+
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		int width = 0, height = 0;
+		float scale = 0;
+		U8* data = queue.Take(paths[i].c_str(), width, height, scale);
+		CHECK(data != NULL && width == 4 && height == 4 && scale == 1);
+		CHECK(data && data[0] == (U8) paths[i].size());
+		free(data);
+
+		// handed over once
+		CHECK(queue.Take(paths[i].c_str(), width, height, scale) == NULL);
+	}
+	CHECK(sStarted == 8);
+}
+
+// Clear() while a worker decodes, the job is freed by the worker
+static void TestClearWhileDecoding(EmscriptenDecodeQueue& queue)
+{
+	SetGate(false);
+	sStarted = sFinished = 0;
+	queue.Prefetch(NULL, Paths("cleared", 1), 0);
+	CHECK(WaitFor([] { return sStarted == 1; }));
+	queue.Clear();
+	SetGate(true);
+	CHECK(WaitFor([] { return sFinished == 1; }));
+
+	int width = 0, height = 0;
+	float scale = 0;
+	CHECK(queue.Take("cleared0.png", width, height, scale) == NULL);
+}
+
+// The main thread takes files in reverse order while workers decode them, every file is decoded
+// by a worker or on the main thread and none is handed over twice
+static void TestTakeRacesWorkers(EmscriptenDecodeQueue& queue)
+{
+	const int kCount = 2000;
+	std::vector<std::string> paths = Paths("race", kCount);
+	sStarted = sFinished = 0;
+	queue.Prefetch(NULL, paths, 0);
+
+	int taken = 0;
+	for (int i = kCount - 1; i >= 0; i--)
+	{
+		int width = 0, height = 0;
+		float scale = 0;
+		U8* data = queue.Load(paths[i].c_str(), width, height, scale);
+		CHECK(data != NULL && width == 4);
+		taken += (data != NULL);
+		free(data);
+		queue.Poll();
+	}
+	CHECK(taken == kCount);
+
+	// duplicated work only for files taken while a worker had them
+	CHECK(WaitFor([] { return sStarted == sFinished; }));
+	queue.Clear();
+}
+
+int main()
+{
+	sMainThread = std::this_thread::get_id();
+
+	// a Take() which waits for the gate never returns, fail instead of hanging
+	std::thread watchdog([] {
+		std::this_thread::sleep_for(std::chrono::seconds(60));
+		fprintf(stderr, "decode_queue_test: timed out\n");
+		_Exit(1);
+	});
+	watchdog.detach();
+
+	{
+		EmscriptenDecodeQueue queue;
+		TestTakeDoesNotWait(queue);
+		TestTakePrefetched(queue);
+		TestClearWhileDecoding(queue);
+		TestTakeRacesWorkers(queue);
+	}
+
+	printf("decode_queue_test: %s\n", sFailures ? "FAILED" : "passed");
+	return sFailures ? 1 : 0;
+}
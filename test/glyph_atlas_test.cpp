@@ -0,0 +1,161 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// EmscriptenGlyphAtlas: line wrapping always, rendering when built with Rtt_EMSCRIPTEN_NATIVE_TEXT and SDL_ttf.
+// The font is $TEST_FONT, DejaVu Sans by default.
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenGlyphAtlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Rtt;
+
+static int sFailures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); sFailures++; } } while (0)
+
+// Lines of str as "begin-end:width" separated by spaces, every character advances 10 pixels, CJK ones 20
+static std::string Wrap(const char* str, int width)
+{
+	std::vector<U32> text;
+	std::vector<int> advances;
+	for (const char* s = str; *s; s++)
+	{
+		U32 ch = (*s == '#') ? 0x4E00 : (U8) *s;
+		text.push_back(ch);
+		advances.push_back(ch == 0x4E00 ? 20 : 10);
+	}
+
+	std::vector<EmscriptenGlyphAtlas::Line> lines;
+	EmscriptenGlyphAtlas::Layout(text, advances, width, lines);
+
+	std::string result;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		char line[64];
+		snprintf(line, sizeof(line), "%s%d-%d:%d", i ? " " : "", (int) lines[i].fBegin, (int) lines[i].fEnd, lines[i].fWidth);
+		result += line;
+	}
+	return result;
+}
+
+#define CHECK_WRAP(str, width, expected) do { \
+		std::string lines = Wrap(str, width); \
+		if (lines != expected) { fprintf(stderr, "%s:%d: Wrap(\"%s\", %d) is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, str, width, lines.c_str(), expected); sFailures++; } \
+	} while (0)
+
+static void TestLayout()
+{
+	CHECK_WRAP("", 100, "0-0:0");
+	CHECK_WRAP("hello world", 0, "0-11:110");
+	CHECK_WRAP("hello world", 200, "0-11:110");
+
+	// the space before a wrap is dropped
+	CHECK_WRAP("hello world", 60, "0-5:50 6-11:50");
+	CHECK_WRAP("hello world", 50, "0-5:50 6-11:50");
+	CHECK_WRAP("aa  bb", 40, "0-2:20 4-6:20");
+
+	// explicit newlines, trailing spaces are kept as typed
+	CHECK_WRAP("a\nb", 0, "0-1:10 2-3:10");
+	CHECK_WRAP("ab \n", 100, "0-3:30 4-4:0");
+
+	// a word wider than the box is split between characters
+	CHECK_WRAP("abcdefghij", 35, "0-3:30 3-6:30 6-9:30 9-10:10");
+	CHECK_WRAP("a abcdefghij", 35, "0-1:10 2-5:30 5-8:30 8-11:30 11-12:10");
+
+	// CJK breaks between any two characters
+	CHECK_WRAP("####", 50, "0-2:40 2-4:40");
+	CHECK_WRAP("ab##", 50, "0-3:40 3-4:20");
+}
+
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+
+static int Coverage(const U8* data, int width, int x0, int x1, int height)
+{
+	int sum = 0;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = x0; x < x1; x++)
+		{
+			sum += data[y * width + x];
+		}
+	}
+	return sum;
+}
+
+static void TestRender()
+{
+	const char* path = getenv("TEST_FONT");
+	path = path ? path : "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		printf("glyph_atlas_test: %s not found, rendering is not tested\n", path);
+		return;
+	}
+	fclose(f);
+
+	std::string name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+	name = name.substr(0, name.find('.'));
+
+	EmscriptenGlyphAtlas atlas;
+	atlas.AddFontFile(path);
+	atlas.SetEnabled(true);
+	CHECK(atlas.IsEnabled());
+
+	int ascent = 0, descent = 0, height = 0, lineSkip = 0;
+	CHECK(atlas.GetFontMetrics(name.c_str(), 20, ascent, descent, height, lineSkip));
+	CHECK(ascent > 0 && descent < 0 && lineSkip > 0);
+
+	// rows are padded to 4 bytes, the height is one line
+	int w = 0, h = 0, mw = 0, mh = 0;
+	U8* data = atlas.Render("Hello", name.c_str(), 20, 0, 0, "left", w, h);
+	CHECK(data != NULL);
+	CHECK(atlas.Measure("Hello", name.c_str(), 20, 0, mw, mh));
+	CHECK(w % 4 == 0 && w >= mw && w < mw + 4 && h == lineSkip && mh == lineSkip);
+	CHECK(data && Coverage(data, w, 0, w, h) > 0);
+	free(data);
+
+	// a text of the same glyphs rasterizes nothing
+	EmscriptenGlyphAtlas::Stats before = atlas.GetStats();
+	data = atlas.Render("Hell o", name.c_str(), 20, 0, 0, "left", w, h);
+	CHECK(data != NULL && atlas.GetStats().fGlyphs == before.fGlyphs + 1);		// the space
+	free(data);
+
+	// wrapped in a box, right aligned text leaves the left empty
+	data = atlas.Render("Hello world", name.c_str(), 20, 200, 0, "right", w, h);
+	CHECK(data != NULL && w == 200 && h == lineSkip);
+	CHECK(data && Coverage(data, w, 0, 50, h) == 0 && Coverage(data, w, 150, 200, h) > 0);
+	free(data);
+
+	data = atlas.Render("Hello world", name.c_str(), 20, 60, 0, "left", w, h);
+	CHECK(data != NULL && h == 2 * lineSkip);
+	free(data);
+
+	// the same rounding of the size as the canvas renderer
+	CHECK(atlas.Measure("Hello", name.c_str(), 19.6f, 0, w, h) && w == mw && h == mh);
+
+	// fonts without a file are left to the canvas renderer
+	CHECK(atlas.Render("Hello", "NoSuchFont", 20, 0, 0, "left", w, h) == NULL);
+}
+
+#endif
+
+int main()
+{
+	TestLayout();
+#if defined(Rtt_EMSCRIPTEN_NATIVE_TEXT)
+	TestRender();
+#endif
+
+	printf("glyph_atlas_test: %s\n", sFailures ? "FAILED" : "passed");
+	return sFailures ? 1 : 0;
+}
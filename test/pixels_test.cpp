@@ -0,0 +1,251 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// EmscriptenPixels against scalar references at every length around the vector widths, then timed against the
+// loops Rtt_EmscriptenBitmap.cpp used before the kernels. Run with an argument to set the benchmark image side, 0 skips it.
+// Native builds take the SSE2 path, add -mssse3 to CXXFLAGS for the RGB shuffle.
+
+#include "Core/Rtt_Build.h"
+#include "Rtt_EmscriptenPixels.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace Rtt;
+
+static int sFailures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); sFailures++; } } while (0)
+
+static std::vector<U8> RandomPixels(size_t bytes)
+{
+	std::vector<U8> result(bytes);
+	for (size_t i = 0; i < bytes; i++)
+	{
+		result[i] = (U8) (rand() >> 4);
+	}
+	return result;
+}
+
+static int ExactDiv(int numerator, int denominator)
+{
+	return (2 * numerator + denominator) / (2 * denominator);
+}
+
+// every (color, alpha) pair, then each kernel at lengths 0..67 with the remainder after the vector loop
+static void TestKernels()
+{
+	std::vector<U8> all(256 * 256 * 4), out(all.size());
+	for (int a = 0; a < 256; a++)
+	{
+		for (int c = 0; c < 256; c++)
+		{
+			U8* p = &all[(a * 256 + c) * 4];
+			p[0] = (U8) c;
+			p[1] = (U8) (255 - c);
+			p[2] = (U8) (c ^ a);
+			p[3] = (U8) a;
+		}
+	}
+
+	EmscriptenPixels::Premultiply(&out[0], &all[0], 256 * 256);
+	int mismatches = 0;
+	for (size_t i = 0; i < all.size(); i += 4)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			mismatches += out[i + k] != ExactDiv(all[i + k] * all[i + 3], 255);
+		}
+		mismatches += out[i + 3] != all[i + 3];
+	}
+	CHECK(mismatches == 0);
+
+	// a reciprocal table, within 1 of the exact quotient
+	EmscriptenPixels::Unpremultiply(&out[0], &all[0], 256 * 256);
+	mismatches = 0;
+	for (size_t i = 0; i < all.size(); i += 4)
+	{
+		int a = all[i + 3];
+		for (int k = 0; k < 3; k++)
+		{
+			int expected = a ? ExactDiv(all[i + k] * 255, a) : 0;
+			expected = expected > 255 ? 255 : expected;
+			mismatches += abs(out[i + k] - expected) > 1;
+		}
+	}
+	CHECK(mismatches == 0);
+
+	for (size_t count = 0; count < 68; count++)
+	{
+		std::vector<U8> rgba = RandomPixels(count * 4 + 1), rgb = RandomPixels(count * 3 + 1);
+		std::vector<U8> dst(count * 4 + 1, 0xCD);
+
+		// in place, as the loaders call it
+		std::vector<U8> inPlace = rgba;
+		EmscriptenPixels::Premultiply(&inPlace[0], &inPlace[0], count);
+		bool ok = inPlace[count * 4] == rgba[count * 4];
+		for (size_t i = 0; i < count * 4; i++)
+		{
+			ok = ok && inPlace[i] == ((i & 3) == 3 ? rgba[i] : ExactDiv(rgba[i] * rgba[i | 3], 255));
+		}
+		CHECK(ok);
+
+		EmscriptenPixels::ExpandRGBToRGBA(&dst[0], &rgb[0], count);
+		ok = dst[count * 4] == 0xCD;
+		for (size_t i = 0; i < count; i++)
+		{
+			ok = ok && memcmp(&dst[i * 4], &rgb[i * 3], 3) == 0 && dst[i * 4 + 3] == 255;
+		}
+		CHECK(ok);
+
+		for (int bpp = 3; bpp <= 4; bpp++)
+		{
+			const U8* src = bpp == 4 ? &rgba[0] : &rgb[0];
+			dst.assign(count + 1, 0xCD);
+			EmscriptenPixels::Luminance(&dst[0], src, count, bpp);
+			ok = dst[count] == 0xCD;
+			for (size_t i = 0; i < count; i++)
+			{
+				const U8* s = src + i * bpp;
+				ok = ok && dst[i] == ((77 * s[0] + 151 * s[1] + 28 * s[2]) >> 8);
+			}
+			CHECK(ok);
+		}
+
+		for (int channel = 0; channel < 4; channel++)
+		{
+			dst.assign(count + 1, 0xCD);
+			EmscriptenPixels::ExtractChannel(&dst[0], &rgba[0], count, channel);
+			ok = dst[count] == 0xCD;
+			for (size_t i = 0; i < count; i++)
+			{
+				ok = ok && dst[i] == rgba[i * 4 + channel];
+			}
+			CHECK(ok);
+		}
+
+		// a single translucent pixel anywhere makes the image not opaque
+		std::vector<U8> opaque = rgba;
+		for (size_t i = 0; i < count; i++)
+		{
+			opaque[i * 4 + 3] = 255;
+		}
+		CHECK(EmscriptenPixels::IsOpaque(&opaque[0], count));
+		for (size_t i = 0; i < count; i++)
+		{
+			opaque[i * 4 + 3] = 254;
+			CHECK(!EmscriptenPixels::IsOpaque(&opaque[0], count));
+			opaque[i * 4 + 3] = 255;
+		}
+	}
+}
+
+//
+// The loops of Rtt_EmscriptenBitmap.cpp before EmscriptenPixels
+//
+
+static void OldPremultiply(U8* dst, const U8* rgba, int w, int h)
+{
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			dst[0] = (rgba[0] * rgba[3]) >> 8;
+			dst[1] = (rgba[1] * rgba[3]) >> 8;
+			dst[2] = (rgba[2] * rgba[3]) >> 8;
+			dst[3] = rgba[3];
+
+			dst += 4;
+			rgba += 4;
+		}
+	}
+}
+
+static void OldExpandRGBToRGBA(U8* dst, const U8* src, int w, int h)
+{
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+			dst[3] = 255;
+			dst += 4;
+			src += 3;
+		}
+	}
+}
+
+static void OldLuminance(U8* dst, const U8* src, int w, int h, int bpp)
+{
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			*dst++ = (U8)(0.30f * src[0] + 0.59f * src[1] + 0.11f * src[2]);
+			src += bpp;
+		}
+	}
+}
+
+// best of 5 runs in ms
+template <typename F>
+static double Time(F f)
+{
+	double best = 1e9;
+	for (int run = 0; run < 5; run++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		f();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		best = ms < best ? ms : best;
+	}
+	return best;
+}
+
+static void Report(const char* name, double before, double after)
+{
+	printf("pixels_test: %-14s %7.2f ms before, %7.2f ms after, %5.1fx\n", name, before, after, before / after);
+}
+
+static void Benchmark(int side)
+{
+	size_t count = (size_t) side * side;
+	std::vector<U8> rgba = RandomPixels(count * 4), rgb = RandomPixels(count * 3);
+	std::vector<U8> dst(count * 4);
+	printf("pixels_test: %dx%d\n", side, side);
+
+	Report("premultiply",
+		Time([&] { OldPremultiply(&dst[0], &rgba[0], side, side); }),
+		Time([&] { EmscriptenPixels::Premultiply(&dst[0], &rgba[0], count); }));
+	Report("RGB to RGBA",
+		Time([&] { OldExpandRGBToRGBA(&dst[0], &rgb[0], side, side); }),
+		Time([&] { EmscriptenPixels::ExpandRGBToRGBA(&dst[0], &rgb[0], count); }));
+	Report("luminance",
+		Time([&] { OldLuminance(&dst[0], &rgba[0], side, side, 4); }),
+		Time([&] { EmscriptenPixels::Luminance(&dst[0], &rgba[0], count, 4); }));
+}
+
+int main(int argc, char* argv[])
+{
+	srand(1);
+	TestKernels();
+
+	int side = argc > 1 ? atoi(argv[1]) : 2048;
+	if (side > 0 && sFailures == 0)
+	{
+		Benchmark(side);
+	}
+
+	printf("pixels_test: %s\n", sFailures ? "FAILED" : "passed");
+	return sFailures ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// $jsNetworkResumableDownload of Rtt_EmscriptenPlatform.js under node, with FS, the heap and fetch mocked.
+// The served resource is 1000 bytes with byte i == i & 255. In "fail" mode a transfer breaks after 300 bytes.
+
+'use strict';
+
+const fs = require('fs');
+const path = require('path');
+
+const library = fs.readFileSync(path.join(__dirname, '..', 'Rtt_EmscriptenPlatform.js'), 'utf8')
+	.replace(/^﻿/, '').replace(/\r\n/g, '\n');
+
+// the source of a library function as an expression
+function libraryFunction(name) {
+	const begin = library.indexOf('\t' + name + ': function');
+	const end = library.indexOf('\n\t},', begin);
+	return '(' + library.slice(library.indexOf('function', begin), end + 3).trim() + ')';
+}
+
+//
+// Mocks
+//
+
+const files = {};
+let fileReads = 0;
+
+global.FS = {
+	mkdir() {},
+	readFile(p, opts) {
+		if (!(p in files)) throw new Error('ENOENT');
+		return opts ? Buffer.from(files[p]).toString() : Uint8Array.from(files[p]);
+	},
+	writeFile(p, data) { files[p] = Array.from(Buffer.from(data)); },
+	unlink(p) { if (!(p in files)) throw new Error('ENOENT'); delete files[p]; },
+	stat(p) { if (!(p in files)) throw new Error('ENOENT'); return { size: files[p].length }; },
+	open(p, mode) { if (mode == 'w' || !(p in files)) files[p] = []; return p; },
+	write(stream, data, offset, length) { for (let i = 0; i < length; i++) files[stream].push(data[offset + i]); },
+	read(stream, buffer, offset, length, position) {
+		fileReads++;
+		for (let i = 0; i < length; i++) buffer[offset + i] = files[stream][position + i];
+		return length;
+	},
+	close() {},
+};
+
+global.HEAPU8 = new Uint8Array(1 << 16);
+let heapTop = 8;
+global._malloc = (size) => { const p = heapTop; heapTop += size; return p; };
+global._free = () => {};
+
+const cstrings = {};
+global.Module = {
+	printErr() {},
+	jstr2cstr(s) { const p = _malloc(1); cstrings[p] = s; return p; },
+};
+global.XMLHttpRequest = { DONE: 4 };
+global.location = { href: 'http://x/index.html', origin: 'http://x' };
+global.navigator = { onLine: true };
+
+const results = [];
+global._jsNetworkDispatch = (requestPtr, readyState, status, size, body, headers) => {
+	const bytes = HEAPU8.slice(body, body + size);
+	results.push({ status, size, intact: bytes.every((v, i) => v == (i & 255)), headers: cstrings[headers] });
+};
+global.jsNetworkDispatchDone = (requestPtr, status, body, headers) => {
+	results.push({ status, size: body.length, headers });
+};
+global.jsNetworkParseHeaders = eval(libraryFunction('$jsNetworkParseHeaders'));
+global.jsNetworkResponseHeaders = eval(libraryFunction('$jsNetworkResponseHeaders'));
+const download = eval(libraryFunction('$jsNetworkResumableDownload'));
+
+const DATA = new Uint8Array(1000).map((_, i) => i & 255);
+let mode = 'ok';
+let etag = '"abc"';
+let requests = [];		// [Range, If-Range] of every fetch
+
+global.fetch = async (url, options) => {
+	const range = options.headers.get('Range');
+	requests.push([range, options.headers.get('If-Range')]);
+	const start = range ? parseInt(range.slice(6), 10) : 0;
+	const headers = new Headers({ ETag: etag });
+
+	if (mode == 'reject' && range) {
+		throw new TypeError('Failed to fetch');
+	}
+
+	if (range) {
+		headers.set('Content-Range', `bytes ${start}-999/1000`);
+	}
+	headers.set('Content-Length', String(1000 - start));
+
+	let body = DATA.slice(start);
+	if (mode == 'fail') {
+		let sent = false;
+		body = new ReadableStream({
+			pull(controller) {
+				if (!sent) {
+					controller.enqueue(DATA.slice(start, start + 300));
+					sent = true;
+				} else {
+					controller.error(new Error('network'));
+				}
+			},
+		});
+	}
+	return new Response(body, { status: range ? 206 : 200, headers });
+};
+
+//
+// Tests
+//
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+function check(cond, what) {
+	console.log((cond ? 'ok   ' : 'FAIL ') + what);
+	if (!cond) {
+		process.exitCode = 1;
+	}
+}
+
+// leaves a partial file of the url, the retry resumes once so it holds 600 bytes
+async function interrupt(url) {
+	mode = 'fail';
+	download(url, '', 0);
+	await sleep(50);
+	results.length = 0;
+}
+
+async function run(url) {
+	requests = [];
+	download(url, '', 0);
+	await sleep(50);
+	return results.pop();
+}
+
+(async () => {
+	Module.networkMaxRetries = 1;
+	Module.networkRetryDelay = 1;
+	Module.documentsDirLoaded = 1;
+
+	await interrupt('http://x/a');
+	check(Object.keys(files).some((p) => p.startsWith('/documentsDir/.corona_downloads/')), 'partial file is in the IDBFS mount');
+
+	mode = 'ok';
+	fileReads = 0;
+	let r = await run('http://x/a');
+	check(requests[0][0] == 'bytes=600-' && requests[0][1] == '"abc"', 'same origin sends Range and If-Range');
+	check(r.status == 200 && r.size == 1000 && r.intact && fileReads == 1, 'resumed body is read once into the heap');
+	check(!/content-range/.test(r.headers) && /content-length: 1000\r\n/.test(r.headers), 'resumed 200 has the headers of the whole file');
+	check(Object.keys(files).length == 0, 'partial file is deleted');
+
+	await interrupt('http://y/b');
+	mode = 'ok';
+	r = await run('http://y/b');
+	check(requests[0][0] == 'bytes=600-' && requests[0][1] == null, 'cross origin sends Range only');
+	check(r.status == 200 && r.size == 1000 && r.intact, 'cross origin download is resumed');
+
+	await interrupt('http://y/c');
+	mode = 'ok';
+	etag = '"changed"';
+	r = await run('http://y/c');
+	etag = '"abc"';
+	check(requests.length == 2 && requests[1][0] == null && r.size == 1000 && r.intact, 'a 206 of another version restarts from zero');
+
+	await interrupt('http://y/d');
+	mode = 'reject';
+	Module.networkMaxRetries = 2;
+	r = await run('http://y/d');
+	Module.networkMaxRetries = 1;
+	check(requests.length == 2 && requests[1][0] == null && r.status == 200 && r.size == 1000, 'a ranged request rejected by the network restarts from zero');
+
+	await interrupt('http://y/e');
+	navigator.onLine = false;
+	mode = 'reject';
+	await run('http://y/e');
+	navigator.onLine = true;
+	check(Object.keys(files).some((p) => p.endsWith('.part')), 'partial file is kept while offline');
+})();
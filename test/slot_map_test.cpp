@@ -0,0 +1,148 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// slot_map of Rtt_EmscriptenContainer.h as PlatformSDLAudioPlayer uses it for sounds: thousands of sounds are loaded
+// and disposed in random order, every handle ever returned is checked after each round.
+
+#include "Rtt_EmscriptenContainer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+
+static int sFailures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); sFailures++; } } while (0)
+
+// stands in for sdlSound, which frees its Mix_Chunk when the last reference goes
+struct Sound : public ref_counted
+{
+	Sound(int id) : fId(id) { sLive++; }
+	virtual ~Sound() { sLive--; }
+
+	int fId;
+	static int sLive;
+};
+
+int Sound::sLive = 0;
+
+typedef slot_map< smart_ptr<Sound> > Sounds;
+
+// every live handle finds its own sound, every disposed one finds nothing
+static void CheckHandles(Sounds& sounds, const std::map<int, int>& live, const std::vector<int>& disposed)
+{
+	for (std::map<int, int>::const_iterator it = live.begin(); it != live.end(); ++it)
+	{
+		smart_ptr<Sound>* sound = sounds.get(it->first);
+		CHECK(sound && *sound != NULL && (*sound)->fId == it->second);
+	}
+	for (size_t i = 0; i < disposed.size(); i++)
+	{
+		CHECK(sounds.get(disposed[i]) == NULL);
+	}
+	CHECK(sounds.size() == (int) live.size());
+	CHECK(Sound::sLive == (int) live.size());
+}
+
+static void TestStress()
+{
+	Sounds sounds;
+	std::map<int, int> live;		// handle -> id of the sound
+	std::vector<int> disposed;
+	int nextId = 0;
+	srand(1);
+
+	for (int round = 0; round < 50; round++)
+	{
+		// load up to 5000 sounds, dispose about half of them in random order
+		int loads = rand() % 5000;
+		for (int i = 0; i < loads; i++)
+		{
+			int handle = sounds.insert(new Sound(nextId));
+			CHECK(handle >= 0 && live.count(handle) == 0);
+			live[handle] = nextId++;
+		}
+
+		std::vector<int> handles;
+		for (std::map<int, int>::const_iterator it = live.begin(); it != live.end(); ++it)
+		{
+			handles.push_back(it->first);
+		}
+		for (size_t i = 0; i < handles.size(); i++)
+		{
+			if (rand() % 2)
+			{
+				CHECK(sounds.remove(handles[i]));
+				CHECK(!sounds.remove(handles[i]));		// a second audio.dispose()
+				live.erase(handles[i]);
+				disposed.push_back(handles[i]);
+			}
+		}
+
+		CheckHandles(sounds, live, disposed);
+	}
+
+	for (std::map<int, int>::const_iterator it = live.begin(); it != live.end(); ++it)
+	{
+		CHECK(sounds.remove(it->first));
+		disposed.push_back(it->first);
+	}
+	live.clear();
+	CheckHandles(sounds, live, disposed);
+
+	CHECK(sounds.get(-1) == NULL);
+	CHECK(sounds.get(0) == NULL);
+	CHECK(sounds.get(Sounds::max_size - 1) == NULL);
+	CHECK(!sounds.remove(-1));
+}
+
+// a sound disposed while a channel plays it stays alive until the channel lets it go
+static void TestPlaying()
+{
+	Sounds sounds;
+	int handle = sounds.insert(new Sound(1));
+	smart_ptr<Sound> channel = *sounds.get(handle);
+
+	CHECK(sounds.remove(handle));
+	CHECK(sounds.get(handle) == NULL && Sound::sLive == 1 && channel->fId == 1);
+
+	channel = NULL;
+	CHECK(Sound::sLive == 0);
+}
+
+// one slot reused many times, no earlier handle of it may come back to life
+static void TestReuse()
+{
+	Sounds sounds;
+	std::vector<int> disposed;
+	for (int i = 0; i < Sounds::generation_mask - 1; i++)
+	{
+		int handle = sounds.insert(new Sound(i));
+		CHECK(handle >= 0 && (handle & (Sounds::max_size - 1)) == 0);
+		CHECK(sounds.remove(handle));
+		disposed.push_back(handle);
+	}
+
+	int handle = sounds.insert(new Sound(-1));
+	for (size_t i = 0; i < disposed.size(); i++)
+	{
+		CHECK(disposed[i] != handle && sounds.get(disposed[i]) == NULL);
+	}
+	CHECK(sounds.get(handle) && (*sounds.get(handle))->fId == -1);
+}
+
+int main()
+{
+	TestStress();
+	TestPlaying();
+	TestReuse();
+
+	printf("slot_map_test: %s\n", sFailures ? "FAILED" : "passed");
+	return sFailures ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// jsNetworkRequestFile of Rtt_EmscriptenPlatform.js under node, with FS, XMLHttpRequest and fetch mocked.
+// The uploaded file is 50MB, sent in 1MB chunks.
+
+'use strict';
+
+const fs = require('fs');
+const path = require('path');
+
+const library = fs.readFileSync(path.join(__dirname, '..', 'Rtt_EmscriptenPlatform.js'), 'utf8')
+	.replace(/^﻿/, '').replace(/\r\n/g, '\n');
+
+// the source of a library function as an expression
+function libraryFunction(name) {
+	const begin = library.indexOf('\t' + name + ': function');
+	const end = library.indexOf('\n\t},', begin);
+	return '(' + library.slice(library.indexOf('function', begin), end + 3).trim() + ')';
+}
+
+const MB = 1024 * 1024;
+const FILE_SIZE = 50 * MB;
+
+//
+// Mocks
+//
+
+// MEMFS keeps a file in a typed array which may be larger than the file
+const contents = new Uint8Array(FILE_SIZE + 12345);
+for (let i = 0; i < FILE_SIZE; i += 4096) {
+	contents[i] = (i / 4096) & 255;
+}
+
+let chunksRead = 0;
+global.FS = {
+	stat(p) { if (p != '/documentsDir/replay.bin') throw new Error('ENOENT'); return { size: FILE_SIZE }; },
+	open(p) { return { position: 0 }; },
+	read(stream, buffer, offset, length, position) {
+		chunksRead++;
+		buffer.set(contents.subarray(position, position + length), offset);
+		return length;
+	},
+	close() {},
+	lookupPath(p) { return { node: { contents } }; },
+	readFile() { throw new Error('the whole file is copied'); },
+};
+
+global.UTF8ToString = (s) => s;
+global.Module = { printErr() {} };
+
+const progress = [];
+global._jsNetworkUploadProgress = (callback, requestPtr, sent, total) => progress.push([sent, total]);
+
+const results = [];
+global.jsNetworkDispatchDone = (requestPtr, status, body, headers) => results.push({ requestPtr, status, size: body.length });
+global.jsNetworkParseHeaders = eval(libraryFunction('$jsNetworkParseHeaders'));
+global.jsNetworkResponseHeaders = eval(libraryFunction('$jsNetworkResponseHeaders'));
+const requestFile = eval(libraryFunction('jsNetworkRequestFile'));
+
+// fetch reads the body slowly and records how far the upload got ahead of it
+let fetchMode = 'stream';
+let maxAhead = 0;
+let received = 0;
+let checksumOk = true;
+global.fetch = async (url, options) => {
+	if (fetchMode == 'http1') {
+		throw new TypeError('Failed to fetch');
+	}
+
+	const reader = options.body.getReader();
+	for (;;) {
+		await new Promise((resolve) => setImmediate(resolve));
+		const { done, value } = await reader.read();
+		if (done) {
+			break;
+		}
+		for (let i = (4096 - received % 4096) % 4096; i < value.length; i += 4096) {
+			checksumOk = checksumOk && value[i] == (((received + i) / 4096) & 255);
+		}
+		received += value.length;
+		maxAhead = Math.max(maxAhead, chunksRead * MB - received);
+	}
+	return new Response('ok', { status: 201, headers: { 'X-Upload': options.headers.get('X-Upload') } });
+};
+
+let xhrBody = null;
+global.XMLHttpRequest = function () {
+	this.upload = {};
+};
+global.XMLHttpRequest.DONE = 4;
+global.XMLHttpRequest.prototype.open = function () {};
+global.XMLHttpRequest.prototype.setRequestHeader = function () {};
+global.XMLHttpRequest.prototype.getAllResponseHeaders = function () { return ''; };
+global.XMLHttpRequest.prototype.send = function (body) {
+	xhrBody = body;
+	for (let loaded = 64 * 1024; loaded <= FILE_SIZE; loaded += 64 * 1024) {
+		this.upload.onprogress({ loaded, total: FILE_SIZE });
+	}
+	this.readyState = 4;
+	this.status = 200;
+	this.response = new ArrayBuffer(2);
+	this.onreadystatechange();
+};
+
+//
+// Tests
+//
+
+function check(cond, what) {
+	console.log((cond ? 'ok   ' : 'FAIL ') + what);
+	if (!cond) {
+		process.exitCode = 1;
+	}
+}
+
+async function waitForResult() {
+	while (results.length == 0) {
+		await new Promise((resolve) => setTimeout(resolve, 1));
+	}
+	return results.pop();
+}
+
+(async () => {
+	check(requestFile('http://x/upload', 'POST', '', '/missing', 1, 0) == 0, 'a missing file is not sent');
+
+	check(requestFile('http://x/upload', 'POST', 'X-Upload: 1', '/documentsDir/replay.bin', 2, 7) == 1, 'upload started');
+	check(Module.networkRequestStreams === true, 'streamed request bodies detected');
+	let r = await waitForResult();
+	check(r.requestPtr == 2 && r.status == 201 && r.size == 2, 'response dispatched');
+	check(received == FILE_SIZE && checksumOk, 'whole file streamed');
+	check(chunksRead == 50, 'file read in 1MB chunks');
+	check(maxAhead <= 2 * MB, 'at most ' + (maxAhead / MB) + ' chunks queued ahead of the network');
+	check(progress.length == 50 && progress[49][0] == FILE_SIZE && progress[49][1] == FILE_SIZE, 'progress once per chunk');
+
+	// a server on HTTP/1.1 refuses streamed bodies
+	fetchMode = 'http1';
+	progress.length = 0;
+	requestFile('http://x/upload', 'POST', '', '/documentsDir/replay.bin', 3, 7);
+	r = await waitForResult();
+	check(r.requestPtr == 3 && r.status == 200, 'falls back to XMLHttpRequest');
+	check(xhrBody.buffer === contents.buffer && xhrBody.length == FILE_SIZE, 'XMLHttpRequest sends a view on the file');
+	check(progress.length == 50 && progress[49][0] == FILE_SIZE, 'XMLHttpRequest progress once per chunk');
+})();
@@ -0,0 +1,157 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of the Corona game engine.
+// For overview and more information on licensing please refer to README.md
+// Home page: https://github.com/coronalabs/corona
+// Contact: support@coronalabs.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// $jsTextLayout of Rtt_EmscriptenPlatform.js under node with a mocked canvas context, then a 5,000 character paragraph
+// timed against the wrapping loop jsRenderText had before it. measureText costs time per character as it does in a browser.
+
+'use strict';
+
+const fs = require('fs');
+const path = require('path');
+
+const library = fs.readFileSync(path.join(__dirname, '..', 'Rtt_EmscriptenPlatform.js'), 'utf8')
+	.replace(/^﻿/, '').replace(/\r\n/g, '\n');
+
+// the source of a library function as an expression
+function libraryFunction(name) {
+	const begin = library.indexOf('\t' + name + ': function');
+	const end = library.indexOf('\n\t},', begin);
+	return '(' + library.slice(library.indexOf('function', begin), end + 3).trim() + ')';
+}
+
+//
+// Mocks
+//
+
+// every character advances 10 pixels, CJK ones 20
+let measured = 0;
+let measuredChars = 0;
+const ctx = {
+	font: '20px sans-serif',
+	measureText(s) {
+		measured++;
+		measuredChars += s.length;
+		let width = 0;
+		for (let i = 0; i < s.length; i++) {
+			width += s.charCodeAt(i) >= 0x2E80 ? 20 : 10;
+		}
+		return { width };
+	},
+};
+
+global.Module = {};
+const layout = eval(libraryFunction('$jsTextLayout'));
+
+// the wrapping loop of jsRenderText before $jsTextLayout, measuring the growing line after every character
+function oldLayout(ctx, text, w) {
+	const lines = [];
+	let line = '';
+	for (let i = 0; i < text.length; i++) {
+		if (text.charAt(i) == '\n') {
+			lines.push(line);
+			line = '';
+		}
+		else {
+			const testLine = line + text.charAt(i);
+			const metrics = ctx.measureText(testLine);
+			if (metrics.width > w) {
+				if (text.charAt(i) === ' ') {
+					lines.push(line);
+					line = '';
+				}
+				else {
+					const a = line.split(' ');
+					if (a.length > 1) {
+						line = a[a.length - 1] + text.charAt(i);
+						a.pop();
+						lines.push(a.join(' '));
+					}
+					else {
+						lines.push(line);
+						line = text.charAt(i);
+					}
+				}
+			}
+			else {
+				line = testLine;
+			}
+		}
+	}
+	lines.push(line);
+	return lines;
+}
+
+//
+// Tests
+//
+
+function check(cond, what) {
+	console.log((cond ? 'ok   ' : 'FAIL ') + what);
+	if (!cond) {
+		process.exitCode = 1;
+	}
+}
+
+function lines(text, w) {
+	return layout(ctx, text, w).lines.join('|');
+}
+
+check(lines('hello world', 0) == 'hello world' && layout(ctx, 'hello world', 0).width == 110, 'no wrapping without a width');
+check(lines('hello world', 60) == 'hello|world' && layout(ctx, 'hello world', 60).width == 50, 'the space before a wrap is dropped');
+check(lines('a\nb', 0) == 'a|b', 'explicit newlines');
+check(lines('ab \n', 100) == 'ab |', 'trailing spaces before a newline are kept');
+check(lines('abcdefghij', 35) == 'abc|def|ghi|j', 'a word wider than the box is split');
+check(lines('一一一一', 50) == '一一|一一', 'CJK breaks between characters');
+
+// a 5,000 character paragraph of words up to 12 letters, in a 300 pixel box
+const words = [];
+let seed = 1;
+for (let length = 0; length < 5000; ) {
+	seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+	const word = 'abcdefghijkl'.slice(0, 1 + (seed >> 8) % 12);
+	words.push(word);
+	length += word.length + 1;
+}
+const paragraph = words.join(' ').slice(0, 5000);
+
+// best of 5 runs in ms, the advance cache is emptied before each
+function time(f) {
+	let best = Infinity;
+	for (let run = 0; run < 5; run++) {
+		Module.appTextAdvances = null;
+		measured = 0;
+		measuredChars = 0;
+		const start = process.hrtime.bigint();
+		f();
+		best = Math.min(best, Number(process.hrtime.bigint() - start) / 1e6);
+	}
+	return best;
+}
+
+const result = layout(ctx, paragraph, 300);
+const oldLines = oldLayout(ctx, paragraph, 300);
+const oldTime = time(() => oldLayout(ctx, paragraph, 300));
+const oldCalls = measured;
+const oldChars = measuredChars;
+const newTime = time(() => layout(ctx, paragraph, 300));
+const newCalls = measured;
+const newChars = measuredChars;
+
+check(result.lines.join(' ') == paragraph, 'the paragraph is wrapped at spaces only');
+check(result.lines.every((line) => ctx.measureText(line).width <= 300) && result.width <= 300, 'every line fits');
+check(result.lines.join('|') == oldLines.join('|'), 'the lines are the same as before');
+check(newCalls <= 13, 'measureText once per distinct word and the space, ' + newCalls + ' calls');
+
+measured = 0;
+layout(ctx, paragraph, 300);
+check(measured == 0, 'a second layout in the same font measures nothing');
+
+console.log('text_layout_test: ' + paragraph.length + ' characters, ' + result.lines.length + ' lines');
+console.log('text_layout_test: before ' + oldTime.toFixed(2) + ' ms, ' + oldCalls + ' measureText calls of ' + oldChars + ' characters');
+console.log('text_layout_test: after  ' + newTime.toFixed(2) + ' ms, ' + newCalls + ' measureText calls of ' + newChars + ' characters');